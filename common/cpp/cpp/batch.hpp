@@ -0,0 +1,411 @@
+/**
+ * @file batch.hpp
+ * @brief Declares the batch runner that solves many input files of a day on a pool of worker threads.
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <system_error>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @namespace batch
+ * @brief Solves both parts of a day for every input file of a batch and streams the answers out as they complete.
+ *
+ * Usage: <day> --batch [--format=csv|json] [--workers=<n>] [--list=<file>] [<file or directory>...]
+ * Directories contribute every regular file they contain, a list file contributes one path per line ("-" reads
+ * the list from stdin). Inputs are claimed one at a time by the workers, so only the inputs currently being
+ * solved are held in memory, however many inputs a batch has. Each answer is written as one CSV row or one JSON
+ * object per line in order of completion; an input that cannot be solved gets a row with its error instead.
+ *
+ * The workers are threads of one process rather than one process per input. An input is solved in milliseconds,
+ * so starting a process for each would add a noticeable share to the work, and with threads the results reach the
+ * writer and the summary without any pipes or serialization. The price is isolation: an exception thrown by the
+ * solver only fails its own input, but an input that crashes the solver, by a segmentation fault or an abort, ends
+ * the whole batch, and solvers must not share unsynchronized global state.
+ */
+namespace batch
+{
+    /**
+     * @struct Answers
+     * @brief The answers of part one and part two for one input.
+     */
+    struct Answers
+    {
+        size_t part_one, part_two;
+    };
+
+    /**
+     * @brief Solves both parts of one input file, normally by constructing a ManagerClass and querying it.
+     */
+    using Solver = std::function<Answers(const std::string &filename)>;
+
+    enum Format
+    {
+        CSV,
+        JSON
+    };
+
+    /**
+     * @struct Options
+     * @brief The options of a batch, parsed from the command line.
+     */
+    struct Options
+    {
+        Format format = Format::CSV;
+        size_t workers = 0;
+        std::vector<std::string> paths;
+        std::vector<std::string> list_files;
+    };
+
+    /**
+     * @brief Parses the value of --workers, which must consist of a non-negative integer only.
+     * @param value The text after --workers=.
+     * @return The number of workers, 0 for hardware concurrency.
+     * @throws std::invalid_argument if the value is not a non-negative integer.
+     */
+    inline size_t parse_workers(const std::string &value)
+    {
+        size_t workers = 0;
+        auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), workers);
+        if (value.empty() || error != std::errc() || end != value.data() + value.size())
+            throw std::invalid_argument("Error: The number of workers " + value + " needs to be a non-negative integer.");
+        return workers;
+    }
+
+    /**
+     * @brief Parses the arguments following --batch.
+     * @param arguments The arguments, without the program name and --batch.
+     * @return The options of the batch.
+     * @throws std::invalid_argument if an argument is unknown or has an invalid value.
+     */
+    inline Options parse_options(const std::vector<std::string> &arguments)
+    {
+        Options options;
+        for (const auto &argument : arguments)
+        {
+            if (argument == "--format=csv")
+                options.format = Format::CSV;
+            else if (argument == "--format=json")
+                options.format = Format::JSON;
+            else if (argument.starts_with("--workers="))
+                options.workers = parse_workers(argument.substr(10));
+            else if (argument.starts_with("--list="))
+                options.list_files.push_back(argument.substr(7));
+            else if (argument.starts_with("--"))
+                throw std::invalid_argument("Error: Unknown batch argument " + argument + ".");
+            else
+                options.paths.push_back(argument);
+        }
+        if (options.paths.empty() && options.list_files.empty())
+            throw std::invalid_argument("Error: A batch needs at least one input file, directory or list.");
+        if (options.workers == 0)
+            options.workers = std::max(1u, std::thread::hardware_concurrency());
+        return options;
+    }
+
+    /**
+     * @class InputSource
+     * @brief Hands out the input files of a batch one at a time, expanding directories and reading lists lazily.
+     *
+     * Directories and list files are only opened once the inputs before them have been claimed, so the source
+     * never holds more than one path, one open directory and one open list at a time.
+     * @param paths Input files and directories.
+     * @param list_files Files listing one input path per line, "-" for stdin.
+     */
+    class InputSource
+    {
+    public:
+        InputSource(std::vector<std::string> paths, std::vector<std::string> list_files)
+            : paths(std::move(paths)), list_files(std::move(list_files)) {}
+
+        /**
+         * @brief Claims the next input, safe to call from many workers.
+         * @return The path of the next input, or nothing once all inputs have been claimed.
+         * @throws std::runtime_error if a list file does not exist or a directory cannot be read.
+         */
+        std::optional<std::string> next()
+        {
+            std::lock_guard<std::mutex> lock(source_mutex);
+            while (true)
+            {
+                if (directory != std::filesystem::directory_iterator())
+                {
+                    std::filesystem::path path = directory->path();
+                    std::error_code error;
+                    directory.increment(error);
+                    if (error)
+                        directory = std::filesystem::directory_iterator();
+                    if (std::filesystem::is_regular_file(path, error))
+                        return path.string();
+                    continue;
+                }
+                if (list != nullptr)
+                {
+                    std::string line;
+                    if (std::getline(*list, line))
+                    {
+                        if (!line.empty() && line.back() == '\r')
+                            line.pop_back();
+                        if (!line.empty())
+                            return line;
+                        continue;
+                    }
+                    list = nullptr;
+                    list_file.close();
+                }
+                if (next_path < paths.size())
+                {
+                    const std::string &path = paths[next_path++];
+                    std::error_code error;
+                    if (!std::filesystem::is_directory(path, error))
+                        return path;
+                    directory = std::filesystem::directory_iterator(path, error);
+                    if (error)
+                        throw std::runtime_error("Error: The directory " + path + " cannot be read.");
+                    continue;
+                }
+                if (next_list_file < list_files.size())
+                {
+                    open_list(list_files[next_list_file++]);
+                    continue;
+                }
+                return std::nullopt;
+            }
+        }
+
+    private:
+        std::mutex source_mutex;
+        std::vector<std::string> paths, list_files;
+        size_t next_path = 0, next_list_file = 0;
+        std::filesystem::directory_iterator directory;
+        std::ifstream list_file;
+        std::istream *list = nullptr;
+
+        void open_list(const std::string &filename)
+        {
+            if (filename == "-")
+            {
+                list = &std::cin;
+                return;
+            }
+            list_file.open(filename);
+            if (!list_file)
+                throw std::runtime_error("Error: The list file " + filename + " does not exist.");
+            list = &list_file;
+        }
+    };
+
+    /**
+     * @struct Result
+     * @brief The outcome of solving one input, either its answers or the error that stopped it.
+     */
+    struct Result
+    {
+        std::string filename;
+        std::optional<Answers> answers;
+        std::string error;
+        std::chrono::nanoseconds elapsed;
+    };
+
+    /**
+     * @brief Quotes a field for CSV if it contains a separator, quote or line break.
+     */
+    inline std::string quote_csv(const std::string &field)
+    {
+        if (field.find_first_of(",\"\r\n") == std::string::npos)
+            return field;
+        std::string quoted = "\"";
+        for (char c : field)
+        {
+            if (c == '"')
+                quoted += '"';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    /**
+     * @brief Escapes a string and wraps it in quotes for JSON.
+     */
+    inline std::string quote_json(const std::string &field)
+    {
+        std::ostringstream quoted;
+        quoted << '"';
+        for (unsigned char c : field)
+        {
+            if (c == '"' || c == '\\')
+                quoted << '\\' << c;
+            else if (c < 0x20)
+                quoted << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+            else
+                quoted << c;
+        }
+        quoted << '"';
+        return quoted.str();
+    }
+
+    /**
+     * @class ResultWriter
+     * @brief Writes results as they complete, one line each, safe to call from many workers.
+     * @param os The stream to write to.
+     * @param format Whether to write CSV rows or JSON objects.
+     */
+    class ResultWriter
+    {
+    public:
+        ResultWriter(std::ostream &os, Format format) : os(os), format(format)
+        {
+            if (format == Format::CSV)
+                os << "input,part_one,part_two,error,elapsed_ms" << std::endl;
+        }
+
+        void write(const Result &result)
+        {
+            double elapsed_ms = std::chrono::duration<double, std::milli>(result.elapsed).count();
+            std::ostringstream line;
+            line << std::fixed << std::setprecision(3);
+            if (format == Format::CSV)
+            {
+                line << quote_csv(result.filename) << ",";
+                if (result.answers)
+                    line << result.answers->part_one << "," << result.answers->part_two << ",,";
+                else
+                    line << ",," << quote_csv(result.error) << ",";
+                line << elapsed_ms;
+            }
+            else
+            {
+                line << "{\"input\": " << quote_json(result.filename) << ", ";
+                if (result.answers)
+                    line << "\"part_one\": " << result.answers->part_one << ", \"part_two\": " << result.answers->part_two;
+                else
+                    line << "\"error\": " << quote_json(result.error);
+                line << ", \"elapsed_ms\": " << elapsed_ms << "}";
+            }
+
+            std::lock_guard<std::mutex> lock(writer_mutex);
+            os << line.str() << std::endl;
+        }
+
+    private:
+        std::mutex writer_mutex;
+        std::ostream &os;
+        Format format;
+    };
+
+    /**
+     * @struct Summary
+     * @brief The number of inputs of a batch that were solved and that failed.
+     */
+    struct Summary
+    {
+        size_t solved, failed;
+    };
+
+    /**
+     * @brief Solves every input of a batch on a pool of workers, writing each result as soon as it completes.
+     * @param source The inputs of the batch.
+     * @param solver Solves both parts of one input.
+     * @param writer Receives the result of every input.
+     * @param workers The number of worker threads.
+     * @return The number of solved and failed inputs.
+     * @throws std::runtime_error if a list file does not exist or a directory cannot be read.
+     */
+    inline Summary run(InputSource &source, const Solver &solver, ResultWriter &writer, size_t workers)
+    {
+        std::atomic<size_t> solved{0}, failed{0};
+        std::exception_ptr source_error;
+        std::mutex source_error_mutex;
+        auto work = [&]()
+        {
+            while (true)
+            {
+                std::optional<std::string> filename;
+                try
+                {
+                    filename = source.next();
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(source_error_mutex);
+                    if (!source_error)
+                        source_error = std::current_exception();
+                    return;
+                }
+                if (!filename)
+                    return;
+
+                Result result{*filename, std::nullopt, "", std::chrono::nanoseconds(0)};
+                auto start = std::chrono::steady_clock::now();
+                try
+                {
+                    result.answers = solver(*filename);
+                    ++solved;
+                }
+                catch (const std::exception &ex)
+                {
+                    result.error = ex.what();
+                    ++failed;
+                }
+                result.elapsed = std::chrono::steady_clock::now() - start;
+                writer.write(result);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(workers - 1);
+        for (size_t worker = 1; worker < workers; ++worker)
+        {
+            threads.emplace_back(work);
+        }
+        work();
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+        if (source_error)
+            std::rethrow_exception(source_error);
+        return {solved.load(), failed.load()};
+    }
+
+    /**
+     * @brief Runs a batch from the arguments following --batch, writing the results to stdout and a summary to stderr.
+     * @param arguments The arguments, without the program name and --batch.
+     * @param solver Solves both parts of one input.
+     * @return The exit code of the program, 0 if every input was solved.
+     */
+    inline int run_from_command_line(const std::vector<std::string> &arguments, const Solver &solver)
+    {
+        try
+        {
+            Options options = parse_options(arguments);
+            InputSource source(options.paths, options.list_files);
+            ResultWriter writer(std::cout, options.format);
+            Summary summary = run(source, solver, writer, options.workers);
+            std::cerr << "Solved " << summary.solved << " inputs, " << summary.failed << " failed." << std::endl;
+            return summary.failed == 0 ? 0 : 1;
+        }
+        catch (const std::exception &ex)
+        {
+            std::cerr << ex.what() << std::endl;
+            return 2;
+        }
+    }
+}
@@ -0,0 +1,262 @@
+/**
+ * @file bench.hpp
+ * @brief Declares the benchmark harness and synthetic input generators shared by the benchmarks of every day.
+ *
+ * The harness replaces the global operator new and delete to count allocations, so it must be included
+ * by exactly one translation unit of a benchmark executable, the one defining main.
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+
+namespace bench
+{
+    inline std::atomic<size_t> allocations{0};
+    inline std::atomic<size_t> allocated_bytes{0};
+}
+
+void *operator new(std::size_t size)
+{
+    bench::allocations.fetch_add(1, std::memory_order_relaxed);
+    bench::allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void *memory = std::malloc(size == 0 ? 1 : size))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+
+/**
+ * @namespace bench
+ * @brief Measures the time, allocations and peak memory of the ManagerClass entry points and engines of a day.
+ */
+namespace bench
+{
+    /**
+     * @brief Keeps the compiler from optimizing away a value or the computation that produced it.
+     */
+    template <typename T>
+    inline void do_not_optimize(const T &value)
+    {
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+
+    /**
+     * @brief Returns the peak resident set size of the process in KiB.
+     */
+    inline long get_peak_rss_kib()
+    {
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+    }
+
+    /**
+     * @struct Result
+     * @brief The measurements of a single benchmark, averaged over all timed iterations.
+     *
+     * The peak RSS is the peak of the whole process up to the end of the benchmark, so it only grows from one benchmark to the next.
+     */
+    struct Result
+    {
+        std::string name;
+        size_t iterations;
+        double ns_per_op, allocations_per_op, bytes_per_op;
+        long peak_rss_kib;
+    };
+
+    /**
+     * @class Suite
+     * @brief Runs benchmarks in order and reports them side by side.
+     *
+     * Benchmarks named "<group>/<variant>", like "checksum@4096/TWO_POINTER", are compared to the first benchmark
+     * of their group, which makes it easy to put an old engine next to a new one. The command line takes
+     * --filter=<text> to only run benchmarks whose name contains the text, --min-time-ms=<ms> for the minimal
+     * time measured per benchmark and --scale=<factor> to multiply the sizes of the synthetic inputs.
+     */
+    class Suite
+    {
+    public:
+        Suite(const std::string &title, int argc, char *argv[]) : title(title)
+        {
+            for (int i = 1; i < argc; ++i)
+            {
+                std::string argument = argv[i];
+                if (argument.starts_with("--filter="))
+                    filter = argument.substr(9);
+                else if (argument.starts_with("--min-time-ms="))
+                    min_time = std::chrono::milliseconds(std::stoul(argument.substr(14)));
+                else if (argument.starts_with("--scale="))
+                    scale = std::stoul(argument.substr(8));
+                else
+                    throw std::invalid_argument("Error: Unknown benchmark argument " + argument + ".");
+            }
+            if (scale == 0)
+                throw std::invalid_argument("Error: The scale of the benchmark inputs needs to be positive.");
+            print_header();
+        }
+
+        size_t get_scale() const { return scale; }
+
+        /**
+         * @brief Runs a benchmark until at least the minimal time has been measured, in batches of doubling size.
+         *
+         * The function is called once untimed first, to warm up caches and to skip lazily built state. Anything the
+         * function prints to std::cout is discarded while it runs.
+         * @param name The name of the benchmark.
+         * @param function The operation to measure, called without arguments. Its result is kept from being optimized away.
+         */
+        template <typename Function>
+        void run(const std::string &name, Function &&function)
+        {
+            if (!filter.empty() && name.find(filter) == std::string::npos)
+                return;
+
+            NullBuffer discarded_output;
+            std::streambuf *standard_output = std::cout.rdbuf(&discarded_output);
+            do_not_optimize(function());
+            size_t iterations = 0, batch = 1;
+            size_t allocations_before = allocations.load(), bytes_before = allocated_bytes.load();
+            std::chrono::nanoseconds elapsed{0};
+            while (elapsed < min_time)
+            {
+                auto start = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < batch; ++i)
+                {
+                    do_not_optimize(function());
+                }
+                elapsed += std::chrono::steady_clock::now() - start;
+                iterations += batch;
+                batch *= 2;
+            }
+            std::cout.rdbuf(standard_output);
+
+            auto per_op = [iterations](double total) { return total / static_cast<double>(iterations); };
+            results.push_back({name, iterations, per_op(static_cast<double>(elapsed.count())),
+                               per_op(static_cast<double>(allocations.load() - allocations_before)),
+                               per_op(static_cast<double>(allocated_bytes.load() - bytes_before)), get_peak_rss_kib()});
+            print_result(results.back());
+        }
+
+        const std::vector<Result> &get_results() const { return results; }
+
+    private:
+        static constexpr int name_width = 48;
+
+        /**
+         * @class NullBuffer
+         * @brief Stream buffer that discards everything written to it.
+         */
+        class NullBuffer : public std::streambuf
+        {
+        protected:
+            int overflow(int c) override { return traits_type::not_eof(c); }
+            std::streamsize xsputn(const char *, std::streamsize count) override { return count; }
+        };
+
+        std::string title, filter;
+        std::chrono::milliseconds min_time{200};
+        size_t scale = 1;
+        std::vector<Result> results;
+
+        static std::string get_group(const std::string &name) { return name.substr(0, name.rfind('/')); }
+
+        void print_header() const
+        {
+            std::cout << title << " benchmarks (min time " << min_time.count() << " ms, scale " << scale << ")\n";
+            std::cout << std::left << std::setw(name_width) << "benchmark" << std::right << std::setw(12) << "iterations"
+                      << std::setw(16) << "ns/op" << std::setw(14) << "allocs/op" << std::setw(16) << "bytes/op"
+                      << std::setw(14) << "peak RSS KiB" << std::setw(10) << "speedup" << std::endl;
+        }
+
+        /**
+         * @brief Prints one row of the result table, with the speedup over the first benchmark of the same group.
+         */
+        void print_result(const Result &result) const
+        {
+            auto baseline = std::find_if(results.begin(), results.end(), [&result](const Result &other)
+                                         { return get_group(other.name) == get_group(result.name); });
+            std::cout << std::left << std::setw(name_width) << result.name << std::right << std::setw(12) << result.iterations
+                      << std::fixed << std::setprecision(1) << std::setw(16) << result.ns_per_op << std::setw(14)
+                      << result.allocations_per_op << std::setw(16) << result.bytes_per_op << std::setw(14)
+                      << result.peak_rss_kib << std::setprecision(2) << std::setw(9) << baseline->ns_per_op / result.ns_per_op
+                      << "x" << std::endl;
+        }
+    };
+
+    /**
+     * @class Generator
+     * @brief Writes reproducible synthetic puzzle inputs of any size.
+     */
+    class Generator
+    {
+    public:
+        explicit Generator(uint64_t seed = 2024) : random(seed) {}
+
+        /**
+         * @brief Returns a random integer in [min, max].
+         */
+        size_t uniform(size_t min, size_t max) { return std::uniform_int_distribution<size_t>(min, max)(random); }
+
+        /**
+         * @brief Returns true with the given probability.
+         */
+        bool chance(double probability) { return std::bernoulli_distribution(probability)(random); }
+
+        /**
+         * @brief Builds a grid of characters, one line per row.
+         * @param rows The number of rows.
+         * @param cols The number of columns.
+         * @param cell Called as cell(generator, row, col, grid so far) and returns the character of the cell.
+         * @return The grid with a newline after every row.
+         */
+        template <typename Cell>
+        std::string grid(size_t rows, size_t cols, Cell &&cell)
+        {
+            std::string content;
+            content.reserve(rows * (cols + 1));
+            for (size_t r = 0; r < rows; ++r)
+            {
+                for (size_t c = 0; c < cols; ++c)
+                {
+                    content.push_back(cell(*this, r, c, content));
+                }
+                content.push_back('\n');
+            }
+            return content;
+        }
+
+    private:
+        std::mt19937_64 random;
+    };
+
+    /**
+     * @brief Writes a synthetic input to a file, so it can be read by a ManagerClass.
+     * @param filename The path of the file.
+     * @param content The content of the file.
+     * @return The path of the file.
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    inline std::string write_input(const std::string &filename, const std::string &content)
+    {
+        std::ofstream outfile(filename, std::ios::binary);
+        if (!outfile || !outfile.write(content.data(), static_cast<std::streamsize>(content.size())))
+            throw std::runtime_error("Error: The benchmark input " + filename + " cannot be written.");
+        return filename;
+    }
+}
@@ -0,0 +1,184 @@
+/**
+ * @file grid.hpp
+ * @brief Declares the flat, row-major Grid shared by the grid based puzzles.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief Packs a coordinate into a single integer, used to hash positions without the collisions of XOR-ing x and y.
+ * @param x The x (#columns) position.
+ * @param y The y (#rows) position.
+ * @return The coordinate with x in the upper and y in the lower 32 bits.
+ */
+inline uint64_t pack_position(int x, int y)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+}
+
+/**
+ * @class Grid
+ * @brief Two-dimensional map stored row-major in a single contiguous vector.
+ *
+ * Cells are addressed through a flat index, so neighbours are a fixed offset away. The grid can be surrounded
+ * by a border of padding cells holding border_value, which lets neighbour lookups of border cells stay inside
+ * the storage without any bounds checks. Rows and columns always refer to the cells inside the border,
+ * row -1 and column -1 are the first padding cells.
+ * @tparam T The type of a cell.
+ * @param rows The number of rows inside the border.
+ * @param cols The number of columns inside the border.
+ * @param padding The width of the border around the grid.
+ */
+template <typename T>
+class Grid
+{
+public:
+    /**
+     * @brief Index offsets of the neighbours of a cell, ordered up, right, down, left.
+     */
+    using NeighbourOffsets = std::array<std::ptrdiff_t, 4>;
+
+    Grid() : rows(0), cols(0), padding(0), stride(0) {}
+
+    /**
+     * @brief Constructs a grid with every cell set to the same value.
+     * @param rows The number of rows inside the border.
+     * @param cols The number of columns inside the border.
+     * @param value The value of the cells inside the border.
+     * @param padding The width of the border around the grid.
+     * @param border_value The value of the padding cells.
+     */
+    Grid(size_t rows, size_t cols, T value = T{}, size_t padding = 0, T border_value = T{})
+        : rows(rows), cols(cols), padding(padding), stride(cols + 2 * padding),
+          cells((rows + 2 * padding) * stride, border_value)
+    {
+        for (size_t r = 0; r < rows; ++r)
+        {
+            std::fill_n(cells.begin() + index(r, 0), cols, value);
+        }
+    }
+
+    /**
+     * @brief Constructs a grid from a vector of rows, converting every cell to T.
+     * @param rows_of_cells The rows of the grid, which all need the same length.
+     * @param padding The width of the border around the grid.
+     * @param border_value The value of the padding cells.
+     * @throws std::invalid_argument if the rows do not all have the same length.
+     */
+    template <typename U>
+    explicit Grid(const std::vector<std::vector<U>> &rows_of_cells, size_t padding = 0, T border_value = T{})
+        : Grid(rows_of_cells.size(), rows_of_cells.empty() ? 0 : rows_of_cells[0].size(), border_value, padding, border_value)
+    {
+        for (size_t r = 0; r < rows; ++r)
+        {
+            if (rows_of_cells[r].size() != cols)
+                throw std::invalid_argument("Error: All rows of a grid need the same number of columns.");
+            for (size_t c = 0; c < cols; ++c)
+            {
+                cells[index(r, c)] = static_cast<T>(rows_of_cells[r][c]);
+            }
+        }
+    }
+
+    size_t get_rows() const { return rows; }
+    size_t get_cols() const { return cols; }
+    size_t get_padding() const { return padding; }
+
+    /**
+     * @brief Returns the distance between vertically adjacent cells, the number of columns including the border.
+     */
+    size_t get_stride() const { return stride; }
+
+    /**
+     * @brief Returns the number of stored cells including the border, every flat index is smaller than this.
+     */
+    size_t size() const { return cells.size(); }
+    bool empty() const { return rows == 0 || cols == 0; }
+
+    /**
+     * @brief Converts a row and column to a flat index.
+     * @param row The row, -padding up to rows + padding - 1.
+     * @param col The column, -padding up to cols + padding - 1.
+     * @return The flat index of the cell.
+     */
+    size_t index(std::ptrdiff_t row, std::ptrdiff_t col) const
+    {
+        return static_cast<size_t>(row + static_cast<std::ptrdiff_t>(padding)) * stride + static_cast<size_t>(col + static_cast<std::ptrdiff_t>(padding));
+    }
+
+    /**
+     * @brief Returns the row of a flat index, negative or past the last row for padding cells.
+     */
+    std::ptrdiff_t get_row(size_t index) const { return static_cast<std::ptrdiff_t>(index / stride) - static_cast<std::ptrdiff_t>(padding); }
+
+    /**
+     * @brief Returns the column of a flat index, negative or past the last column for padding cells.
+     */
+    std::ptrdiff_t get_col(size_t index) const { return static_cast<std::ptrdiff_t>(index % stride) - static_cast<std::ptrdiff_t>(padding); }
+
+    /**
+     * @brief Checks whether a row and column lie inside the border.
+     */
+    bool contains(std::ptrdiff_t row, std::ptrdiff_t col) const
+    {
+        return row >= 0 && col >= 0 && static_cast<size_t>(row) < rows && static_cast<size_t>(col) < cols;
+    }
+
+    T &operator[](size_t index) { return cells[index]; }
+    const T &operator[](size_t index) const { return cells[index]; }
+    T &at(std::ptrdiff_t row, std::ptrdiff_t col) { return cells[index(row, col)]; }
+    const T &at(std::ptrdiff_t row, std::ptrdiff_t col) const { return cells[index(row, col)]; }
+
+    /**
+     * @brief Returns the index offsets of the four neighbours of a cell, ordered up, right, down, left.
+     */
+    NeighbourOffsets get_neighbour_offsets() const
+    {
+        auto signed_stride = static_cast<std::ptrdiff_t>(stride);
+        return {-signed_stride, 1, signed_stride, -1};
+    }
+
+    /**
+     * @brief Returns the flat index of a neighbour. Only valid without bounds checks if the grid has a border.
+     * @param index The flat index of the cell.
+     * @param direction The direction of the neighbour, 0 = up, 1 = right, 2 = down, 3 = left.
+     */
+    size_t get_neighbour(size_t index, size_t direction) const
+    {
+        return static_cast<size_t>(static_cast<std::ptrdiff_t>(index) + get_neighbour_offsets()[direction]);
+    }
+
+    /**
+     * @brief Calls a function with the flat index of every cell inside the border, in row-major order.
+     * @param function The function to call.
+     */
+    template <typename Function>
+    void for_each_index(Function &&function) const
+    {
+        for (size_t r = 0; r < rows; ++r)
+        {
+            for (size_t i = index(r, 0), end = i + cols; i < end; ++i)
+            {
+                function(i);
+            }
+        }
+    }
+
+    T *data() { return cells.data(); }
+    const T *data() const { return cells.data(); }
+
+    /**
+     * @brief Sets every stored cell, including the border, to the same value.
+     */
+    void fill(const T &value) { std::fill(cells.begin(), cells.end(), value); }
+
+private:
+    size_t rows, cols, padding, stride;
+    std::vector<T> cells;
+};
@@ -0,0 +1,164 @@
+/**
+ * @file grid_file.hpp
+ * @brief Declares the memory-mapped loader for the grid shaped puzzle inputs.
+ */
+#pragma once
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "grid.hpp"
+
+/**
+ * @class GridFile
+ * @brief Maps a grid shaped input file into memory and hands out its rows without copying them.
+ *
+ * Rows are the lines of the file, found with memchr, with a trailing carriage return stripped and empty lines
+ * skipped. All rows need the same width. The mapping lives as long as the GridFile, so the rows returned by
+ * get_row must not outlive it; to_grid copies the cells into a Grid in a single pass instead.
+ * @param filename The path to the input file.
+ */
+class GridFile
+{
+public:
+    /**
+     * @brief Maps the file into memory and finds its rows.
+     * @param filename The path to the input file.
+     * @throws std::runtime_error if the file does not exist, is empty or cannot be mapped.
+     * @throws std::invalid_argument if the lines of the file differ in length.
+     */
+    explicit GridFile(const std::string &filename)
+    {
+        int file_descriptor = open(filename.c_str(), O_RDONLY);
+        if (file_descriptor < 0)
+            throw std::runtime_error("Error: The file " + filename + " does not exist.");
+
+        struct stat status{};
+        if (fstat(file_descriptor, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0)
+        {
+            length = static_cast<size_t>(status.st_size);
+            void *mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+            if (mapping != MAP_FAILED)
+            {
+                content = static_cast<const char *>(mapping);
+                madvise(mapping, length, MADV_SEQUENTIAL);
+            }
+        }
+        close(file_descriptor);
+        if (content == nullptr)
+            throw std::runtime_error("Error: The file " + filename + " is empty or invalid.");
+
+        find_rows();
+        if (row_starts.empty())
+        {
+            unmap();
+            throw std::runtime_error("Error: The file " + filename + " is empty or invalid.");
+        }
+    }
+
+    ~GridFile() { unmap(); }
+
+    GridFile(const GridFile &) = delete;
+    GridFile &operator=(const GridFile &) = delete;
+
+    GridFile(GridFile &&other) noexcept
+        : content(std::exchange(other.content, nullptr)), length(std::exchange(other.length, 0)),
+          cols(other.cols), row_starts(std::move(other.row_starts)) {}
+
+    size_t get_rows() const { return row_starts.size(); }
+    size_t get_cols() const { return cols; }
+
+    /**
+     * @brief Returns a row of the file without its line ending, pointing into the mapping.
+     * @param row The row, 0 up to get_rows() - 1.
+     */
+    std::string_view get_row(size_t row) const { return {content + row_starts[row], cols}; }
+
+    /**
+     * @brief Copies the cells into a grid, converting every character with a function.
+     * @tparam T The type of a cell.
+     * @param padding The width of the border around the grid.
+     * @param border_value The value of the padding cells.
+     * @param convert Called with the character of a cell and returns its value.
+     * @return The grid of the file.
+     */
+    template <typename T, typename Convert>
+    Grid<T> to_grid(size_t padding, T border_value, Convert &&convert) const
+    {
+        Grid<T> grid(get_rows(), cols, border_value, padding, border_value);
+        for (size_t r = 0; r < get_rows(); ++r)
+        {
+            const char *line = content + row_starts[r];
+            T *cells = grid.data() + grid.index(static_cast<std::ptrdiff_t>(r), 0);
+            for (size_t c = 0; c < cols; ++c)
+            {
+                cells[c] = convert(line[c]);
+            }
+        }
+        return grid;
+    }
+
+    /**
+     * @brief Copies the characters into a grid.
+     * @param padding The width of the border around the grid.
+     * @param border_value The value of the padding cells.
+     * @return The grid of the file.
+     */
+    Grid<char> to_grid(size_t padding = 0, char border_value = '\0') const
+    {
+        return to_grid<char>(padding, border_value, [](char c) { return c; });
+    }
+
+private:
+    const char *content = nullptr;
+    size_t length = 0, cols = 0;
+    std::vector<size_t> row_starts;
+
+    /**
+     * @brief Finds the start of every non-empty line and checks that they all have the same width.
+     * @throws std::invalid_argument if the lines of the file differ in length.
+     */
+    void find_rows()
+    {
+        const char *end = content + length;
+        bool first_row = true;
+        for (const char *line = content; line < end;)
+        {
+            const char *newline = static_cast<const char *>(std::memchr(line, '\n', static_cast<size_t>(end - line)));
+            const char *line_end = newline != nullptr ? newline : end;
+            size_t width = static_cast<size_t>(line_end - line);
+            if (width > 0 && line[width - 1] == '\r')
+                --width;
+            if (width > 0)
+            {
+                if (first_row)
+                {
+                    cols = width;
+                    row_starts.reserve(length / (cols + 1) + 1);
+                    first_row = false;
+                }
+                else if (width != cols)
+                {
+                    unmap();
+                    throw std::invalid_argument("Error: All rows of a grid need the same number of columns.");
+                }
+                row_starts.push_back(static_cast<size_t>(line - content));
+            }
+            line = line_end + 1;
+        }
+    }
+
+    void unmap()
+    {
+        if (content != nullptr)
+            munmap(const_cast<char *>(content), length);
+        content = nullptr;
+    }
+};
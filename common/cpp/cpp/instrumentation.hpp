@@ -0,0 +1,191 @@
+/**
+ * @file instrumentation.hpp
+ * @brief Declares the counters and phase timers that show where the work of a puzzle run goes.
+ *
+ * Instrumentation is compiled in with -DENABLE_INSTRUMENTATION, which the Makefiles set for INSTRUMENTATION=1.
+ * Without it, counters and timers never register, their methods are empty and the instrumented hot paths
+ * compile to the same code as without them.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+/**
+ * @namespace instrumentation
+ * @brief Named counters and phase timers shared by all translation units of a program, dumped as JSON.
+ */
+namespace instrumentation
+{
+#if defined(ENABLE_INSTRUMENTATION)
+    inline constexpr bool enabled = true;
+#else
+    inline constexpr bool enabled = false;
+#endif
+
+    /**
+     * @struct Metric
+     * @brief A named value that many threads can add to. Phases use the value for nanoseconds and also count their calls.
+     */
+    struct Metric
+    {
+        std::string name;
+        bool is_phase;
+        std::atomic<uint64_t> value{0};
+        std::atomic<uint64_t> calls{0};
+    };
+
+    /**
+     * @class Registry
+     * @brief Owns every metric of the process, metrics with the same name and kind are the same metric.
+     */
+    class Registry
+    {
+    public:
+        static Registry &shared()
+        {
+            static Registry registry;
+            return registry;
+        }
+
+        /**
+         * @brief Returns the metric with a name and kind, creating it on first use.
+         */
+        Metric &get(const std::string &name, bool is_phase)
+        {
+            std::lock_guard<std::mutex> lock(metrics_mutex);
+            for (auto &metric : metrics)
+            {
+                if (metric.name == name && metric.is_phase == is_phase)
+                    return metric;
+            }
+            return metrics.emplace_back(name, is_phase);
+        }
+
+        /**
+         * @brief Writes all metrics as one JSON object, counters first and phases second, in order of registration.
+         */
+        void write_json(std::ostream &os)
+        {
+            std::lock_guard<std::mutex> lock(metrics_mutex);
+            os << "{\"counters\": {";
+            write_metrics(os, false);
+            os << "}, \"phases\": {";
+            write_metrics(os, true);
+            os << "}}" << std::endl;
+        }
+
+    private:
+        std::mutex metrics_mutex;
+        std::deque<Metric> metrics;
+
+        void write_metrics(std::ostream &os, bool phases) const
+        {
+            const char *separator = "";
+            for (const auto &metric : metrics)
+            {
+                if (metric.is_phase != phases)
+                    continue;
+                os << separator << "\"" << metric.name << "\": ";
+                if (phases)
+                    os << "{\"calls\": " << metric.calls.load() << ", \"ns\": " << metric.value.load() << "}";
+                else
+                    os << metric.value.load();
+                separator = ", ";
+            }
+        }
+    };
+
+    /**
+     * @class Counter
+     * @brief Counts events like simulated steps or hash inserts, meant to be a static object next to the code it counts.
+     *
+     * Adding is a relaxed atomic add, so hot loops should count locally and add once per batch.
+     */
+    class Counter
+    {
+    public:
+        explicit Counter(const char *name)
+        {
+            if constexpr (enabled)
+                metric = &Registry::shared().get(name, false);
+        }
+
+        void add(uint64_t amount = 1)
+        {
+            if constexpr (enabled)
+                metric->value.fetch_add(amount, std::memory_order_relaxed);
+        }
+
+    private:
+        Metric *metric = nullptr;
+    };
+
+    /**
+     * @class Phase
+     * @brief Accumulates the time spent in a phase like parse, compute or reduce, measured by ScopedTimer.
+     */
+    class Phase
+    {
+    public:
+        explicit Phase(const char *name)
+        {
+            if constexpr (enabled)
+                metric = &Registry::shared().get(name, true);
+        }
+
+        void add(std::chrono::nanoseconds elapsed)
+        {
+            if constexpr (enabled)
+            {
+                metric->value.fetch_add(static_cast<uint64_t>(elapsed.count()), std::memory_order_relaxed);
+                metric->calls.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        Metric *metric = nullptr;
+    };
+
+    /**
+     * @class ScopedTimer
+     * @brief Adds the time from its construction to its destruction to a phase.
+     */
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Phase &phase) : phase(phase)
+        {
+            if constexpr (enabled)
+                start = std::chrono::steady_clock::now();
+        }
+
+        ~ScopedTimer()
+        {
+            if constexpr (enabled)
+                phase.add(std::chrono::steady_clock::now() - start);
+        }
+
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+    private:
+        Phase &phase;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    /**
+     * @brief Writes all counters and phases as JSON, nothing is written if instrumentation is disabled.
+     * @param os The stream to write to.
+     */
+    inline void write_json(std::ostream &os)
+    {
+        if constexpr (enabled)
+            Registry::shared().write_json(os);
+    }
+}
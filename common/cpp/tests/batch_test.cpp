@@ -0,0 +1,153 @@
+/**
+ * @file batch_test.cpp
+ * @brief Unit tests for the batch runner.
+ */
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include "batch.hpp"
+
+/**
+ * @brief Creates a fresh directory of test inputs in the build directory, each holding its own number.
+ * @param name The name of the directory.
+ * @param number_of_inputs The number of input files.
+ * @return The path of the directory.
+ */
+static std::string create_test_inputs(const std::string &name, size_t number_of_inputs)
+{
+    std::string directory = "build/" + name;
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory + "/nested");
+    for (size_t i = 0; i < number_of_inputs; ++i)
+    {
+        std::ofstream(directory + "/input_" + std::to_string(i)) << i;
+    }
+    return directory;
+}
+
+/**
+ * @brief Reads the number of a test input, failing for inputs that hold no number.
+ */
+static batch::Answers solve_test_input(const std::string &filename)
+{
+    size_t number;
+    if (!(std::ifstream(filename) >> number))
+        throw std::runtime_error("Error: The file " + filename + " is empty or invalid.");
+    return {number, 2 * number};
+}
+
+/**
+ * @test ParsesOptions
+ * @brief Tests that the format, workers, lists and paths are parsed and unknown arguments are rejected.
+ */
+TEST(BatchTest, ParsesOptions)
+{
+    auto options = batch::parse_options({"--format=json", "--workers=3", "--list=inputs.txt", "a", "b"});
+    EXPECT_EQ(options.format, batch::Format::JSON);
+    EXPECT_EQ(options.workers, 3);
+    EXPECT_EQ(options.list_files, std::vector<std::string>{"inputs.txt"});
+    EXPECT_EQ(options.paths, (std::vector<std::string>{"a", "b"}));
+    EXPECT_GE(batch::parse_options({"a"}).workers, 1);
+    EXPECT_THROW(batch::parse_options({"--format=xml", "a"}), std::invalid_argument);
+    EXPECT_THROW(batch::parse_options({"--workers=2"}), std::invalid_argument);
+    EXPECT_THROW(batch::parse_options({"--workers=2x", "a"}), std::invalid_argument);
+    EXPECT_THROW(batch::parse_options({"--workers=-1", "a"}), std::invalid_argument);
+    EXPECT_THROW(batch::parse_options({"--workers=abc", "a"}), std::invalid_argument);
+    EXPECT_THROW(batch::parse_options({"--workers=", "a"}), std::invalid_argument);
+}
+
+/**
+ * @test RejectedCommandLineWritesNoResults
+ * @brief Tests that an invalid worker count exits with code 2 before the CSV header is written.
+ */
+TEST(BatchTest, RejectedCommandLineWritesNoResults)
+{
+    auto solver = [](const std::string &) { return batch::Answers{0, 0}; };
+    for (const std::string workers : {"--workers=2x", "--workers=-1", "--workers=abc"})
+    {
+        std::ostringstream output, errors;
+        std::streambuf *standard_output = std::cout.rdbuf(output.rdbuf());
+        std::streambuf *standard_error = std::cerr.rdbuf(errors.rdbuf());
+        int exit_code = batch::run_from_command_line({workers, "a"}, solver);
+        std::cout.rdbuf(standard_output);
+        std::cerr.rdbuf(standard_error);
+        EXPECT_EQ(exit_code, 2);
+        EXPECT_TRUE(output.str().empty());
+        EXPECT_NE(errors.str().find("needs to be a non-negative integer"), std::string::npos);
+    }
+}
+
+/**
+ * @test InputSourceExpandsDirectoriesAndLists
+ * @brief Tests that directories contribute their regular files and lists their non-empty lines, each input once.
+ */
+TEST(BatchTest, InputSourceExpandsDirectoriesAndLists)
+{
+    std::string directory = create_test_inputs("batch_source", 3);
+    std::string list = directory + "/nested/list";
+    std::ofstream(list) << "first\r\n\nsecond\n";
+
+    batch::InputSource source({directory, "single"}, {list});
+    std::multiset<std::string> inputs;
+    while (auto input = source.next())
+    {
+        inputs.insert(*input);
+    }
+    std::multiset<std::string> expected{directory + "/input_0", directory + "/input_1", directory + "/input_2", "single", "first", "second"};
+    EXPECT_EQ(inputs, expected);
+
+    batch::InputSource missing_list({}, {"build/nonexistent_list"});
+    EXPECT_THROW(missing_list.next(), std::runtime_error);
+}
+
+/**
+ * @test RunsEveryInputOnWorkers
+ * @brief Tests that every input is solved once on several workers and that failed inputs are reported in their row.
+ */
+TEST(BatchTest, RunsEveryInputOnWorkers)
+{
+    std::string directory = create_test_inputs("batch_run", 50);
+    std::ofstream(directory + "/invalid") << "none";
+
+    for (size_t workers : {1, 4})
+    {
+        batch::InputSource source({directory}, {});
+        std::stringstream output;
+        batch::ResultWriter writer(output, batch::Format::CSV);
+        auto summary = batch::run(source, solve_test_input, writer, workers);
+        EXPECT_EQ(summary.solved, 50);
+        EXPECT_EQ(summary.failed, 1);
+
+        std::string line;
+        std::getline(output, line);
+        EXPECT_EQ(line, "input,part_one,part_two,error,elapsed_ms");
+        std::set<std::string> rows;
+        while (std::getline(output, line))
+        {
+            rows.insert(line.substr(0, line.rfind(',')));
+        }
+        EXPECT_EQ(rows.size(), 51);
+        EXPECT_TRUE(rows.contains(directory + "/input_7,7,14,"));
+        EXPECT_TRUE(rows.contains(directory + "/invalid,,,Error: The file " + directory + "/invalid is empty or invalid."));
+    }
+}
+
+/**
+ * @test WritesJsonAndQuotedCsv
+ * @brief Tests that results are written as one JSON object per line and that CSV fields are quoted when needed.
+ */
+TEST(BatchTest, WritesJsonAndQuotedCsv)
+{
+    std::stringstream json;
+    batch::ResultWriter json_writer(json, batch::Format::JSON);
+    json_writer.write({"dir/in\"put", batch::Answers{1, 2}, "", std::chrono::milliseconds(5)});
+    json_writer.write({"bad", std::nullopt, "Error: line\nbreak", std::chrono::nanoseconds(0)});
+    EXPECT_EQ(json.str(), "{\"input\": \"dir/in\\\"put\", \"part_one\": 1, \"part_two\": 2, \"elapsed_ms\": 5.000}\n"
+                          "{\"input\": \"bad\", \"error\": \"Error: line\\u000abreak\", \"elapsed_ms\": 0.000}\n");
+
+    EXPECT_EQ(batch::quote_csv("plain"), "plain");
+    EXPECT_EQ(batch::quote_csv("a,\"b\""), "\"a,\"\"b\"\"\"");
+}
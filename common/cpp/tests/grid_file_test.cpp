@@ -0,0 +1,67 @@
+/**
+ * @file grid_file_test.cpp
+ * @brief Unit tests for the memory-mapped GridFile loader.
+ */
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <fstream>
+#include "grid_file.hpp"
+
+/**
+ * @brief Writes a test input file into the build directory.
+ * @param name The name of the file.
+ * @param content The content of the file.
+ * @return The path of the file.
+ */
+static std::string write_test_file(const std::string &name, const std::string &content)
+{
+    std::string filename = "build/" + name;
+    std::ofstream(filename, std::ios::binary) << content;
+    return filename;
+}
+
+/**
+ * @test HandsOutRowsWithoutLineEndings
+ * @brief Tests that rows skip empty lines and carriage returns, with or without a final newline.
+ */
+TEST(GridFileTest, HandsOutRowsWithoutLineEndings)
+{
+    GridFile file(write_test_file("grid_file_rows", "abc\r\ndef\n\nghi"));
+    EXPECT_EQ(file.get_rows(), 3);
+    EXPECT_EQ(file.get_cols(), 3);
+    EXPECT_EQ(file.get_row(0), "abc");
+    EXPECT_EQ(file.get_row(1), "def");
+    EXPECT_EQ(file.get_row(2), "ghi");
+}
+
+/**
+ * @test ConvertsToPaddedGrid
+ * @brief Tests that the cells are copied into a grid with a border, converted and unconverted.
+ */
+TEST(GridFileTest, ConvertsToPaddedGrid)
+{
+    GridFile file(write_test_file("grid_file_digits", "012\n345\n"));
+    Grid<char> characters = file.to_grid();
+    EXPECT_EQ(characters.get_rows(), 2);
+    EXPECT_EQ(characters.at(1, 2), '5');
+
+    Grid<uint8_t> digits = file.to_grid<uint8_t>(1, UINT8_MAX, [](char c)
+                                                  { return static_cast<uint8_t>(c - '0'); });
+    EXPECT_EQ(digits.get_padding(), 1);
+    EXPECT_EQ(digits.at(0, 0), 0);
+    EXPECT_EQ(digits.at(1, 2), 5);
+    EXPECT_EQ(digits.at(-1, 0), UINT8_MAX);
+    EXPECT_EQ(digits.at(1, 3), UINT8_MAX);
+}
+
+/**
+ * @test RejectsInvalidFiles
+ * @brief Tests that missing, empty and ragged files are rejected.
+ */
+TEST(GridFileTest, RejectsInvalidFiles)
+{
+    EXPECT_THROW(GridFile("build/nonexistent_file"), std::runtime_error);
+    EXPECT_THROW(GridFile(write_test_file("grid_file_empty", "")), std::runtime_error);
+    EXPECT_THROW(GridFile(write_test_file("grid_file_blank", "\n\n")), std::runtime_error);
+    EXPECT_THROW(GridFile(write_test_file("grid_file_ragged", "abc\nde\n")), std::invalid_argument);
+}
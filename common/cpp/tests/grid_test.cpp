@@ -0,0 +1,80 @@
+/**
+ * @file grid_test.cpp
+ * @brief Unit tests for the shared Grid class.
+ */
+#include "gtest/gtest.h"
+#include <unordered_set>
+#include "grid.hpp"
+
+/**
+ * @test IndexRoundTrip
+ * @brief Tests that rows and columns convert to flat indices and back, with and without a border.
+ */
+TEST(GridTest, IndexRoundTrip)
+{
+    Grid<char> grid(std::vector<std::vector<char>>{{'a', 'b', 'c'}, {'d', 'e', 'f'}});
+    EXPECT_EQ(grid.get_rows(), 2);
+    EXPECT_EQ(grid.get_cols(), 3);
+    EXPECT_EQ(grid.size(), 6);
+    EXPECT_EQ(grid.at(1, 2), 'f');
+    EXPECT_EQ(grid[grid.index(1, 0)], 'd');
+
+    Grid<char> padded(std::vector<std::vector<char>>{{'a', 'b', 'c'}, {'d', 'e', 'f'}}, 1, '#');
+    EXPECT_EQ(padded.size(), 20);
+    EXPECT_EQ(padded.get_stride(), 5);
+    EXPECT_EQ(padded.at(1, 2), 'f');
+    EXPECT_EQ(padded.at(-1, -1), '#');
+    EXPECT_EQ(padded.at(2, 3), '#');
+    EXPECT_EQ(padded.get_row(padded.index(1, 2)), 1);
+    EXPECT_EQ(padded.get_col(padded.index(1, 2)), 2);
+    EXPECT_TRUE(padded.contains(1, 2));
+    EXPECT_FALSE(padded.contains(-1, 0));
+    EXPECT_FALSE(padded.contains(0, 3));
+}
+
+/**
+ * @test NeighboursOfBorderCells
+ * @brief Tests that neighbours are ordered up, right, down, left and land on the border outside the grid.
+ */
+TEST(GridTest, NeighboursOfBorderCells)
+{
+    Grid<int> grid(2, 2, 1, 1, 0);
+    size_t corner = grid.index(0, 0);
+    EXPECT_EQ(grid.get_neighbour(corner, 0), grid.index(-1, 0));
+    EXPECT_EQ(grid.get_neighbour(corner, 1), grid.index(0, 1));
+    EXPECT_EQ(grid.get_neighbour(corner, 2), grid.index(1, 0));
+    EXPECT_EQ(grid.get_neighbour(corner, 3), grid.index(0, -1));
+    EXPECT_EQ(grid[grid.get_neighbour(corner, 0)], 0);
+    EXPECT_EQ(grid[grid.get_neighbour(corner, 1)], 1);
+
+    size_t cells = 0;
+    grid.for_each_index([&](size_t index)
+                        { cells += grid[index]; });
+    EXPECT_EQ(cells, 4);
+}
+
+/**
+ * @test RejectsRaggedRows
+ * @brief Tests that rows of different lengths are rejected.
+ */
+TEST(GridTest, RejectsRaggedRows)
+{
+    EXPECT_THROW(Grid<char>(std::vector<std::vector<char>>{{'a', 'b'}, {'c'}}), std::invalid_argument);
+}
+
+/**
+ * @test PackedPositionsAreUnique
+ * @brief Tests that packed positions do not collide for mirrored coordinates, unlike x ^ y.
+ */
+TEST(GridTest, PackedPositionsAreUnique)
+{
+    std::unordered_set<uint64_t> packed;
+    for (int x = -3; x < 20; ++x)
+    {
+        for (int y = -3; y < 20; ++y)
+        {
+            packed.insert(pack_position(x, y));
+        }
+    }
+    EXPECT_EQ(packed.size(), 23 * 23);
+}
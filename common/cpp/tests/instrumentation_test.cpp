@@ -0,0 +1,69 @@
+/**
+ * @file instrumentation_test.cpp
+ * @brief Unit tests for the shared counters and phase timers, compiled with instrumentation enabled.
+ */
+#define ENABLE_INSTRUMENTATION
+#include "gtest/gtest.h"
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "instrumentation.hpp"
+
+/**
+ * @test CountersWithTheSameNameAreShared
+ * @brief Tests that counters add up across objects with the same name and across threads.
+ */
+TEST(InstrumentationTest, CountersWithTheSameNameAreShared)
+{
+    instrumentation::Counter counter("shared_counter"), same_counter("shared_counter");
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&]()
+                             { for (int i = 0; i < 1000; ++i) counter.add(); });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    same_counter.add(6);
+    EXPECT_EQ(instrumentation::Registry::shared().get("shared_counter", false).value.load(), 4006);
+}
+
+/**
+ * @test ScopedTimerAddsToPhase
+ * @brief Tests that every scoped timer adds one call and its elapsed time to its phase.
+ */
+TEST(InstrumentationTest, ScopedTimerAddsToPhase)
+{
+    instrumentation::Phase phase("timed_phase");
+    for (int i = 0; i < 3; ++i)
+    {
+        instrumentation::ScopedTimer timer(phase);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    auto &metric = instrumentation::Registry::shared().get("timed_phase", true);
+    EXPECT_EQ(metric.calls.load(), 3);
+    EXPECT_GE(metric.value.load(), 3'000'000u);
+}
+
+/**
+ * @test WritesJson
+ * @brief Tests that counters and phases are written as separate JSON objects.
+ */
+TEST(InstrumentationTest, WritesJson)
+{
+    instrumentation::Counter counter("json_counter");
+    counter.add(42);
+    instrumentation::Phase phase("json_phase");
+    phase.add(std::chrono::nanoseconds(7));
+
+    std::stringstream ss;
+    instrumentation::write_json(ss);
+    std::string json = ss.str();
+    EXPECT_EQ(json.rfind("{\"counters\": {", 0), 0);
+    EXPECT_NE(json.find("\"json_counter\": 42"), std::string::npos);
+    EXPECT_NE(json.find("\"json_phase\": {\"calls\": 1, \"ns\": 7}"), std::string::npos);
+    EXPECT_LT(json.find("\"json_counter\""), json.find("\"phases\""));
+    EXPECT_GT(json.find("\"json_phase\""), json.find("\"phases\""));
+}
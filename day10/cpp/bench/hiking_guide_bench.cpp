@@ -0,0 +1,58 @@
+#include "bench.hpp"
+#include "grid_file.hpp"
+#include "hiking_guide.hpp"
+
+/**
+ * @brief Generates a height map that mostly climbs along the anti-diagonals, so it contains many trails.
+ * @param size The number of rows and columns.
+ */
+std::string generate_height_map(bench::Generator &generator, size_t size)
+{
+    return generator.grid(size, size, [](bench::Generator &g, size_t r, size_t c, const std::string &)
+                          { return static_cast<char>('0' + (g.chance(0.8) ? (r + c) % 10 : g.uniform(0, 9))); });
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        bench::Suite suite("Hiking Guide", argc, argv);
+        bench::Generator generator;
+        const std::vector<std::pair<TrailEngine, std::string>> engines{
+            {TrailEngine::TRAILHEAD_DFS, "TRAILHEAD_DFS"}, {TrailEngine::ITERATIVE_TRAILHEAD_DFS, "ITERATIVE_TRAILHEAD_DFS"},
+            {TrailEngine::PARALLEL_TRAILHEAD_DFS, "PARALLEL_TRAILHEAD_DFS"}, {TrailEngine::HEIGHT_DP, "HEIGHT_DP"}};
+        for (size_t size : {64 * suite.get_scale(), 256 * suite.get_scale()})
+        {
+            std::string label = std::to_string(size) + "x" + std::to_string(size);
+            std::string filename = bench::write_input("build/bench_height_map_" + label, generate_height_map(generator, size));
+
+            suite.run("parse@" + label, [&]
+                      { return ManagerClass(filename).get_score(); });
+            Grid<uint8_t> map = GridFile(filename).to_grid<uint8_t>(1, HEIGHT_MAP_BORDER, [](char c)
+                                                                    { return static_cast<uint8_t>(c - '0'); });
+            HikeGuide hike_guide(map, 0);
+            for (const auto &[engine, engine_name] : engines)
+            {
+                suite.run("score@" + label + "/" + engine_name, [&]
+                          { return hike_guide.get_score(engine); });
+            }
+            for (const auto &[engine, engine_name] : engines)
+            {
+                suite.run("rating@" + label + "/" + engine_name, [&]
+                          { return hike_guide.get_sum_rating_of_all_trailheads(engine); });
+            }
+            suite.run("both_parts@" + label + "/MANAGER_PER_PART", [&]
+                      { return ManagerClass(filename).get_score() + ManagerClass(filename).get_sum_rating_of_all_trailheads(); });
+            suite.run("both_parts@" + label + "/SESSION", [&]
+                      {
+                          ManagerClass manager(filename);
+                          return manager.get_score() + manager.get_sum_rating_of_all_trailheads(); });
+        }
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
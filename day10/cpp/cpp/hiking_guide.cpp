@@ -3,6 +3,15 @@
  * @brief Implements classes and methods for hiking map analysis, trailhead scoring, and DFS traversal.
  */
 #include "hiking_guide.hpp"
+#include "instrumentation.hpp"
+
+#include <bit>
+
+static instrumentation::Counter trail_heads_found("trail_heads_found");
+static instrumentation::Counter trail_ends_reached("trail_ends_reached");
+static instrumentation::Counter height_sweeps("height_sweeps");
+static instrumentation::Phase compute_phase("compute");
+static instrumentation::Phase reduce_phase("reduce");
 
 /**
  * @brief Constructs a Position object.
@@ -24,38 +33,38 @@ bool Position::operator==(const Position &other) const
 };
 
 /**
- * @brief Constructs a Trailhead object and initializes reachable ending positions.
- * @param map The hiking map as a 2D vector.
+ * @brief Constructs a Trailhead object. The trails are only traversed once a score or rating is requested.
+ * @param map The hiking map, surrounded by a border of HEIGHT_MAP_BORDER.
  * @param starting_pos The starting position for the trailhead.
  * @param ending_height The target ending height for the trail.
  * @param height_increment The increment for each step in height.
  */
-Trailhead::Trailhead(const std::vector<std::vector<size_t>> &map, const Position &starting_pos, size_t ending_height, size_t height_increment)
+Trailhead::Trailhead(const Grid<uint8_t> &map, const Position &starting_pos, size_t ending_height, size_t height_increment)
     : map(map),
       starting_pos(starting_pos),
       ending_height(ending_height),
       height_increment(height_increment),
-      hike_trails_dfs(HikeTrailsDFS(map, ending_height, height_increment))
-{
-    reachable_ending_positions = hike_trails_dfs.get_reachable_ending_positions(starting_pos);
-}
+      hike_trails_dfs(HikeTrailsDFS(map, ending_height, height_increment)) {}
 
 /**
  * @brief Returns the score for this trailhead (number of reachable ending positions).
+ * @param dfs_stack Stack for an iterative DFS, shared between trailheads. The DFS is recursive if it is nullptr.
  * @return The score as a size_t integer.
  */
-size_t Trailhead::get_score()
+size_t Trailhead::get_score(DFSStack *dfs_stack)
 {
+    reachable_ending_positions = hike_trails_dfs.get_reachable_ending_positions(starting_pos, dfs_stack);
     return reachable_ending_positions.size();
 }
 
 /**
  * @brief Returns the sum of ratings for all trailheads from this starting position.
+ * @param dfs_stack Stack for an iterative DFS, shared between trailheads. The DFS is recursive if it is nullptr.
  * @return The sum of ratings as a size_t integer.
  */
-size_t Trailhead::get_rating_of_trailheads()
+size_t Trailhead::get_rating_of_trailheads(DFSStack *dfs_stack)
 {
-    auto rating_of_trail_heads = hike_trails_dfs.get_rating_of_trailheads(starting_pos);
+    auto rating_of_trail_heads = hike_trails_dfs.get_rating_of_trailheads(starting_pos, dfs_stack);
     size_t sum = 0;
     for (auto &rating : rating_of_trail_heads)
     {
@@ -66,38 +75,71 @@ size_t Trailhead::get_rating_of_trailheads()
 
 /**
  * @brief Constructs a HikeGuide object with the given map.
- * @param map The hiking map as a 2D vector.
+ * @param map The hiking map, surrounded by a border of HEIGHT_MAP_BORDER.
+ * @param number_of_threads Number of worker threads used by PARALLEL_TRAILHEAD_DFS (0 = hardware concurrency).
  */
-HikeGuide::HikeGuide(const std::vector<std::vector<size_t>> &map) : map(map)
+HikeGuide::HikeGuide(const Grid<uint8_t> &map, size_t number_of_threads)
+    : map(map), hike_trails_dp(map, 0, 9, 1),
+      number_of_threads(number_of_threads != 0 ? number_of_threads : std::max(1u, std::thread::hardware_concurrency()))
 {
     find_trail_heads();
-    std::cout << "Trail heads " << trail_heads.size() << std::endl;
 };
 
+/**
+ * @brief Converts rows of heights into a hiking map surrounded by a border of HEIGHT_MAP_BORDER.
+ *
+ * Heights are stored in a single byte; anything that is not a height of a trail, like '.' on the example maps,
+ * ends up as a large value that no trail steps onto.
+ * @param heights The rows of heights.
+ * @return The hiking map as a grid with a border of one cell.
+ */
+Grid<uint8_t> HikeGuide::create_height_map(const std::vector<std::vector<size_t>> &heights)
+{
+    return Grid<uint8_t>(heights, 1, HEIGHT_MAP_BORDER);
+}
+
 /**
  * @brief Returns the total score for all trailheads in the map.
+ * @param trail_engine The algorithm used for evaluating the trailheads.
  * @return The total score as a size_t integer.
  */
-size_t HikeGuide::get_score()
+size_t HikeGuide::get_score(TrailEngine trail_engine)
 {
+    instrumentation::ScopedTimer compute_timer(compute_phase);
+    if (trail_engine == TrailEngine::HEIGHT_DP)
+        return hike_trails_dp.get_sum_score_of_trailheads();
+    if (trail_engine == TrailEngine::PARALLEL_TRAILHEAD_DFS)
+        return evaluate_trail_heads_in_parallel().first;
+
+    DFSStack dfs_stack;
+    DFSStack *shared_stack = trail_engine == TrailEngine::ITERATIVE_TRAILHEAD_DFS ? &dfs_stack : nullptr;
     size_t sum = 0;
     for (auto &trail_head : trail_heads)
     {
-        sum += trail_head.get_score();
+        sum += trail_head.get_score(shared_stack);
     }
     return sum;
 }
 
 /**
  * @brief Returns the sum of ratings for all trailheads in the map.
+ * @param trail_engine The algorithm used for evaluating the trailheads.
  * @return The sum of ratings as a size_t integer.
  */
-size_t HikeGuide::get_sum_rating_of_all_trailheads()
+size_t HikeGuide::get_sum_rating_of_all_trailheads(TrailEngine trail_engine)
 {
+    instrumentation::ScopedTimer compute_timer(compute_phase);
+    if (trail_engine == TrailEngine::HEIGHT_DP)
+        return hike_trails_dp.get_sum_rating_of_trailheads();
+    if (trail_engine == TrailEngine::PARALLEL_TRAILHEAD_DFS)
+        return evaluate_trail_heads_in_parallel().second;
+
+    DFSStack dfs_stack;
+    DFSStack *shared_stack = trail_engine == TrailEngine::ITERATIVE_TRAILHEAD_DFS ? &dfs_stack : nullptr;
     size_t sum = 0;
     for (auto &trail_head : trail_heads)
     {
-        sum += trail_head.get_rating_of_trailheads();
+        sum += trail_head.get_rating_of_trailheads(shared_stack);
     }
     return sum;
 }
@@ -107,42 +149,166 @@ size_t HikeGuide::get_sum_rating_of_all_trailheads()
  */
 void HikeGuide::find_trail_heads()
 {
-    for (int i = 0; i < (int)map.size(); ++i)
+    map.for_each_index([&](size_t index)
+                       {
+        if (map[index] == 0)
+        {
+            trail_heads.push_back(Trailhead(map, Position(map.get_col(index), map.get_row(index), 0), 9, 1));
+            trail_head_indices.push_back(index);
+        } });
+    trail_heads_found.add(trail_heads.size());
+}
+
+/**
+ * @brief Evaluates all trailheads with a DFS, shared between number_of_threads workers that all read the same map.
+ *
+ * Every worker accumulates plain sums in its own TrailheadEvaluator, so the results are combined by adding them up.
+ * @return The total score and the sum of ratings of all trailheads.
+ */
+std::pair<size_t, size_t> HikeGuide::evaluate_trail_heads_in_parallel() const
+{
+    std::atomic<size_t> next_trail_head{0};
+
+    size_t workers = std::min(number_of_threads, trail_head_indices.size());
+    if (workers <= 1)
+    {
+        auto evaluator = evaluate_trail_heads(next_trail_head);
+        return {evaluator.get_score(), evaluator.get_rating()};
+    }
+
+    std::vector<std::pair<size_t, size_t>> sums_per_worker(workers);
+    std::vector<std::thread> threads;
+    threads.reserve(workers);
+    for (size_t worker = 0; worker < workers; ++worker)
+    {
+        threads.emplace_back([&, worker]()
+                             {
+            auto evaluator = evaluate_trail_heads(next_trail_head);
+            sums_per_worker[worker] = {evaluator.get_score(), evaluator.get_rating()}; });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    instrumentation::ScopedTimer reduce_timer(reduce_phase);
+    std::pair<size_t, size_t> sums{0, 0};
+    for (const auto &worker_sums : sums_per_worker)
+    {
+        sums.first += worker_sums.first;
+        sums.second += worker_sums.second;
+    }
+    return sums;
+}
+
+/**
+ * @brief Worker loop that claims trailheads in chunks and evaluates them until none are left.
+ * @param next_trail_head Shared index of the next unclaimed trailhead.
+ * @return The evaluator holding the score and rating of all trailheads this worker evaluated.
+ */
+TrailheadEvaluator HikeGuide::evaluate_trail_heads(std::atomic<size_t> &next_trail_head) const
+{
+    const size_t chunk_size = 64;
+    TrailheadEvaluator evaluator(map, 9, 1);
+
+    size_t start;
+    while ((start = next_trail_head.fetch_add(chunk_size)) < trail_head_indices.size())
     {
-        for (int j = 0; j < (int)map[i].size(); ++j)
+        size_t end = std::min(start + chunk_size, trail_head_indices.size());
+        for (size_t idx = start; idx < end; ++idx)
         {
-            if (map[i][j] == 0)
+            evaluator.evaluate(trail_head_indices[idx]);
+        }
+    }
+    return evaluator;
+}
+
+/**
+ * @brief Constructs a TrailheadEvaluator with a scratch buffer covering every cell of the hiking map.
+ * @param grid The hiking map, surrounded by a border of HEIGHT_MAP_BORDER.
+ * @param stop_value The target value to stop DFS.
+ * @param height_increment The increment for each step in height.
+ * @throws std::invalid_argument if the map has no border or the stop value cannot be told apart from the border.
+ */
+TrailheadEvaluator::TrailheadEvaluator(const Grid<uint8_t> &grid, size_t stop_value, size_t height_increment)
+    : grid(grid),
+      stop_value(stop_value),
+      height_increment(height_increment),
+      generation(0),
+      ending_stamps(grid.size(), 0),
+      score(0),
+      rating(0)
+{
+    if (grid.get_padding() == 0 || stop_value >= HEIGHT_MAP_BORDER)
+        throw std::invalid_argument("Error: The hiking map needs a border of heights above the stop value.");
+}
+
+/**
+ * @brief Adds the score and rating of a trailhead to the accumulated sums.
+ * @param trail_head_index The flat index of the trailhead in the map.
+ */
+void TrailheadEvaluator::evaluate(size_t trail_head_index)
+{
+    if (++generation == 0)
+    {
+        std::fill(ending_stamps.begin(), ending_stamps.end(), 0);
+        generation = 1;
+    }
+
+    // Like HikeTrailsDFS::iterative_dfs, only positions continuing the trail are pushed.
+    size_t rating_before = rating;
+    dfs_stack.clear();
+    dfs_stack.push_back({trail_head_index, grid[trail_head_index]});
+    while (!dfs_stack.empty())
+    {
+        DFSStep step = dfs_stack.back();
+        dfs_stack.pop_back();
+        if (step.target_value == stop_value)
+        {
+            ++rating;
+            if (ending_stamps[step.index] != generation)
             {
-                trail_heads.push_back(Trailhead(map, Position(j, i, 0), 9, 1));
+                ending_stamps[step.index] = generation;
+                ++score;
             }
+            continue;
+        }
+
+        size_t next_value = step.target_value + height_increment;
+        for (auto offset : grid.get_neighbour_offsets())
+        {
+            if (grid[step.index + offset] == next_value)
+                dfs_stack.push_back({step.index + offset, next_value});
         }
     }
+    trail_ends_reached.add(rating - rating_before);
 }
 
 /**
  * @brief Constructs a HikeTrailsDFS object for DFS traversal of the hiking map.
- * @param grid The hiking map as a 2D vector.
+ * @param grid The hiking map, surrounded by a border of HEIGHT_MAP_BORDER.
  * @param stop_value The target value to stop DFS.
  * @param height_increment The increment for each step in height.
+ * @throws std::invalid_argument if the map has no border or the stop value cannot be told apart from the border.
  */
-HikeTrailsDFS::HikeTrailsDFS(const std::vector<std::vector<size_t>> &grid, size_t stop_value, size_t height_increment)
+HikeTrailsDFS::HikeTrailsDFS(const Grid<uint8_t> &grid, size_t stop_value, size_t height_increment)
     : grid(grid),
-      rows(grid.size()),
-      cols(grid[0].size()),
       stop_value(stop_value),
       height_increment(height_increment),
-      processed_dfs(false),
-      visited(rows, std::vector<bool>(cols, false)) {}
+      processed_dfs(false)
+{
+    if (grid.get_padding() == 0 || stop_value >= HEIGHT_MAP_BORDER)
+        throw std::invalid_argument("Error: The hiking map needs a border of heights above the stop value.");
+}
 
 /**
  * @brief Returns the set of reachable ending positions from a given trailhead using DFS.
  * @param trail_head The starting position for DFS.
  * @return An unordered_set of Position objects.
  */
-std::unordered_set<Position> HikeTrailsDFS::get_reachable_ending_positions(Position trail_head)
+std::unordered_set<Position> HikeTrailsDFS::get_reachable_ending_positions(Position trail_head, DFSStack *dfs_stack)
 {
-    dfs(trail_head.y_position, trail_head.x_position, trail_head.value);
-    processed_dfs = true;
+    process_dfs(trail_head, dfs_stack);
     return reachable_ending_positions;
 }
 
@@ -151,47 +317,219 @@ std::unordered_set<Position> HikeTrailsDFS::get_reachable_ending_positions(Posit
  * @param trail_head The starting position for DFS.
  * @return An unordered_map of Position to rating.
  */
-std::unordered_map<Position, size_t> HikeTrailsDFS::get_rating_of_trailheads(Position trail_head)
+std::unordered_map<Position, size_t> HikeTrailsDFS::get_rating_of_trailheads(Position trail_head, DFSStack *dfs_stack)
 {
-    if (!processed_dfs)
-    {
-        dfs(trail_head.y_position, trail_head.x_position, trail_head.value);
-        processed_dfs = true;
-    }
-
+    process_dfs(trail_head, dfs_stack);
     return rating_of_trailheads;
 }
 
+/**
+ * @brief Runs the DFS from a trailhead, unless it already ran.
+ * @param trail_head The starting position for DFS.
+ * @param dfs_stack Stack for an iterative DFS. The DFS is recursive if it is nullptr.
+ */
+void HikeTrailsDFS::process_dfs(const Position &trail_head, DFSStack *dfs_stack)
+{
+    if (processed_dfs)
+        return;
+
+    size_t index = grid.index(trail_head.y_position, trail_head.x_position);
+    if (dfs_stack)
+        iterative_dfs(index, trail_head.value, *dfs_stack);
+    else
+        dfs(index, trail_head.value);
+    processed_dfs = true;
+}
+
 /**
  * @brief Performs DFS traversal from a given position and target value.
- * @param r The row index.
- * @param c The column index.
+ *
+ * The border of the map never matches a target value, so neighbours are visited without bounds checks.
+ * @param index The flat index of the position in the map.
  * @param target_value The target value for the current step.
  */
-void HikeTrailsDFS::dfs(size_t r, size_t c, size_t target_value)
+void HikeTrailsDFS::dfs(size_t index, size_t target_value)
 {
-    if (target_value == stop_value && grid[r][c] == stop_value)
+    if (target_value == stop_value && grid[index] == stop_value)
     {
-        auto ending_position = Position(c, r, grid[r][c]);
-        reachable_ending_positions.emplace(ending_position);
-        if (!rating_of_trailheads.contains(ending_position))
+        add_ending_position(index);
+        return;
+    }
+    if (grid[index] != target_value)
+        return;
+
+    // Hiking trails never include diagonal steps - only up, down, left, or right (from the perspective of the map).
+    for (auto offset : grid.get_neighbour_offsets())
+    {
+        dfs(index + offset, target_value + height_increment);
+    }
+}
+
+/**
+ * @brief Performs the same traversal as dfs, keeping the positions still to visit on an explicit stack.
+ *
+ * Only neighbours continuing the trail are pushed, so the stack never holds more than three positions per height level.
+ * The stack is cleared first and keeps its capacity, which makes reusing it across trailheads free of allocations.
+ * @param index The flat index of the trailhead in the map.
+ * @param target_value The value the trailhead needs to start a trail.
+ * @param dfs_stack The stack to traverse with.
+ */
+void HikeTrailsDFS::iterative_dfs(size_t index, size_t target_value, DFSStack &dfs_stack)
+{
+    dfs_stack.clear();
+    if (grid[index] != target_value)
+        return;
+
+    dfs_stack.push_back({index, target_value});
+    while (!dfs_stack.empty())
+    {
+        DFSStep step = dfs_stack.back();
+        dfs_stack.pop_back();
+        if (step.target_value == stop_value)
         {
-            rating_of_trailheads.insert({ending_position, 1});
+            add_ending_position(step.index);
+            continue;
+        }
+
+        size_t next_value = step.target_value + height_increment;
+        for (auto offset : grid.get_neighbour_offsets())
+        {
+            if (grid[step.index + offset] == next_value)
+                dfs_stack.push_back({step.index + offset, next_value});
         }
-        else
-            rating_of_trailheads[ending_position] += 1;
-        return;
     }
-    if (r >= rows || c >= cols || grid[r][c] != target_value)
+}
+
+/**
+ * @brief Records one more trail reaching an ending position.
+ * @param index The flat index of the ending position in the map.
+ */
+void HikeTrailsDFS::add_ending_position(size_t index)
+{
+    auto ending_position = Position(grid.get_col(index), grid.get_row(index), grid[index]);
+    reachable_ending_positions.emplace(ending_position);
+    rating_of_trailheads[ending_position] += 1;
+    trail_ends_reached.add();
+}
+
+/**
+ * @brief Constructs a HikeTrailsDP object and groups the cells of the hiking map by height.
+ *
+ * Only heights reachable from trail_head_value in steps of height_increment up to stop_value take part in a trail.
+ * @param grid The hiking map, surrounded by a border of HEIGHT_MAP_BORDER.
+ * @param trail_head_value The height trails start at.
+ * @param stop_value The height trails end at.
+ * @param height_increment The increment for each step in height.
+ * @throws std::invalid_argument if the height increment is zero, the map has no border or the stop value cannot be told apart from the border.
+ */
+HikeTrailsDP::HikeTrailsDP(const Grid<uint8_t> &grid, size_t trail_head_value, size_t stop_value, size_t height_increment)
+    : grid(grid),
+      height_increment(height_increment)
+{
+    if (height_increment == 0)
+        throw std::invalid_argument("Error: The height increment has to be larger than zero.");
+    if (grid.get_padding() == 0 || stop_value >= HEIGHT_MAP_BORDER)
+        throw std::invalid_argument("Error: The hiking map needs a border of heights above the stop value.");
+    if (stop_value < trail_head_value || (stop_value - trail_head_value) % height_increment != 0)
         return;
 
+    cells_by_height.resize((stop_value - trail_head_value) / height_increment + 1);
+    grid.for_each_index([&](size_t cell)
+                        {
+        size_t value = grid[cell];
+        if (value < trail_head_value || value > stop_value || (value - trail_head_value) % height_increment != 0)
+            return;
+        cells_by_height[(value - trail_head_value) / height_increment].push_back(cell); });
+}
+
+/**
+ * @brief Calls a function for every neighbour of a cell that is exactly one height increment higher.
+ * @param cell The flat index of the cell.
+ * @param function The function to call with the flat index of the neighbour.
+ */
+template <typename Function>
+void HikeTrailsDP::for_each_higher_neighbour(size_t cell, Function &&function) const
+{
+    size_t next_value = grid[cell] + height_increment;
+
     // Hiking trails never include diagonal steps - only up, down, left, or right (from the perspective of the map).
-    if (r > 0)
-        dfs(r - 1, c, target_value + height_increment); // Up
-    if (r + 1 < rows)
-        dfs(r + 1, c, target_value + height_increment); // Down
-    if (c > 0)
-        dfs(r, c - 1, target_value + height_increment); // Left
-    if (c + 1 < cols)
-        dfs(r, c + 1, target_value + height_increment); // Right
+    for (auto offset : grid.get_neighbour_offsets())
+    {
+        size_t neighbour = cell + offset;
+        if (grid[neighbour] == next_value)
+            function(neighbour);
+    }
+}
+
+/**
+ * @brief Returns the sum of ratings of all trailheads, the number of distinct trails from each trailhead to any ending position.
+ * @return The sum of ratings as a size_t integer.
+ */
+size_t HikeTrailsDP::get_sum_rating_of_trailheads() const
+{
+    if (cells_by_height.empty())
+        return 0;
+
+    height_sweeps.add();
+    std::vector<size_t> rating(grid.size(), 0);
+    for (size_t cell : cells_by_height.back())
+    {
+        rating[cell] = 1;
+    }
+    for (size_t height = cells_by_height.size() - 1; height-- > 0;)
+    {
+        for (size_t cell : cells_by_height[height])
+        {
+            for_each_higher_neighbour(cell, [&](size_t neighbour)
+                                      { rating[cell] += rating[neighbour]; });
+        }
+    }
+
+    size_t sum = 0;
+    for (size_t cell : cells_by_height.front())
+    {
+        sum += rating[cell];
+    }
+    return sum;
+}
+
+/**
+ * @brief Returns the sum of scores of all trailheads, the number of distinct ending positions reachable from each trailhead.
+ *
+ * Every sweep assigns one bit to each of the next 64 ending positions and ORs the bits down the height levels,
+ * the score of a trailhead is then the number of bits set at its cell summed over all sweeps.
+ * @return The sum of scores as a size_t integer.
+ */
+size_t HikeTrailsDP::get_sum_score_of_trailheads() const
+{
+    if (cells_by_height.empty())
+        return 0;
+
+    const auto &ending_positions = cells_by_height.back();
+    std::vector<uint64_t> reachable(grid.size(), 0);
+    size_t sum = 0;
+    for (size_t first_ending = 0; first_ending < ending_positions.size(); first_ending += 64)
+    {
+        height_sweeps.add();
+        for (size_t idx = 0; idx < ending_positions.size(); ++idx)
+        {
+            bool in_sweep = idx >= first_ending && idx - first_ending < 64;
+            reachable[ending_positions[idx]] = in_sweep ? uint64_t{1} << (idx - first_ending) : 0;
+        }
+        for (size_t height = cells_by_height.size() - 1; height-- > 0;)
+        {
+            for (size_t cell : cells_by_height[height])
+            {
+                uint64_t bits = 0;
+                for_each_higher_neighbour(cell, [&](size_t neighbour)
+                                          { bits |= reachable[neighbour]; });
+                reachable[cell] = bits;
+            }
+        }
+        for (size_t cell : cells_by_height.front())
+        {
+            sum += std::popcount(reachable[cell]);
+        }
+    }
+    return sum;
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <vector>
+#include <map>
 #include <unordered_set>
 #include <unordered_map>
 #include <string>
@@ -13,6 +14,34 @@
 #include <fstream>
 #include <stdexcept>
 #include <algorithm>
+#include <cstdint>
+#include <climits>
+#include <atomic>
+#include <thread>
+#include <utility>
+
+#include "grid.hpp"
+
+/**
+ * @enum TrailEngine
+ * @brief Selects the algorithm used to evaluate the trailheads of a hiking map.
+ *
+ * TRAILHEAD_DFS walks every trail from every trailhead, HEIGHT_DP sweeps all cells once per height level.
+ * PARALLEL_TRAILHEAD_DFS walks the same trails as TRAILHEAD_DFS, with the trailheads shared between worker threads.
+ * ITERATIVE_TRAILHEAD_DFS walks the same trails as TRAILHEAD_DFS with an explicit stack instead of recursion.
+ */
+enum TrailEngine
+{
+    TRAILHEAD_DFS,
+    HEIGHT_DP,
+    PARALLEL_TRAILHEAD_DFS,
+    ITERATIVE_TRAILHEAD_DFS
+};
+
+/**
+ * @brief Height of the padding cells around a hiking map. It is never part of a trail, so trails need no bounds checks.
+ */
+constexpr uint8_t HEIGHT_MAP_BORDER = UINT8_MAX;
 
 /**
  * @class Position
@@ -41,39 +70,110 @@ namespace std
     {
         std::size_t operator()(const Position &p) const
         {
-            return std::hash<int>()(p.x_position) ^ std::hash<int>()(p.y_position) ^ std::hash<size_t>()(p.value);
+            return std::hash<uint64_t>()(pack_position(p.x_position, p.y_position));
         }
     };
 }
 
+/**
+ * @brief A position still to be visited by an iterative DFS, with the height it needs to continue the trail.
+ */
+struct DFSStep
+{
+    size_t index, target_value;
+};
+
+/**
+ * @brief Explicit stack of an iterative DFS. It is cleared but not freed between traversals, so it can be reused across trailheads.
+ */
+using DFSStack = std::vector<DFSStep>;
+
 /**
  * @class HikeTrailsDFS
  * @brief Performs DFS traversal on the hiking map to find reachable ending positions and ratings.
- * @param grid The hiking map as a 2D vector.
+ * @param grid The hiking map, surrounded by a border of HEIGHT_MAP_BORDER.
  * @param stop_value The target value to stop DFS.
  * @param height_increment The increment for each step in height.
  */
 class HikeTrailsDFS
 {
 public:
-    HikeTrailsDFS(const std::vector<std::vector<size_t>> &grid, size_t stop_value, size_t height_increment);
-    std::unordered_set<Position> get_reachable_ending_positions(Position trail_head);
-    std::unordered_map<Position, size_t> get_rating_of_trailheads(Position trail_head);
+    HikeTrailsDFS(const Grid<uint8_t> &grid, size_t stop_value, size_t height_increment);
+    std::unordered_set<Position> get_reachable_ending_positions(Position trail_head, DFSStack *dfs_stack = nullptr);
+    std::unordered_map<Position, size_t> get_rating_of_trailheads(Position trail_head, DFSStack *dfs_stack = nullptr);
 
 private:
-    const std::vector<std::vector<size_t>> &grid;
-    size_t rows, cols, stop_value, height_increment;
+    const Grid<uint8_t> &grid;
+    size_t stop_value, height_increment;
     bool processed_dfs;
-    std::vector<std::vector<bool>> visited;
     std::unordered_set<Position> reachable_ending_positions;
     std::unordered_map<Position, size_t> rating_of_trailheads;
-    void dfs(size_t r, size_t c, size_t target_value);
+    void process_dfs(const Position &trail_head, DFSStack *dfs_stack);
+    void dfs(size_t index, size_t target_value);
+    void iterative_dfs(size_t index, size_t target_value, DFSStack &dfs_stack);
+    void add_ending_position(size_t index);
+};
+
+/**
+ * @class HikeTrailsDP
+ * @brief Evaluates all trailheads of the hiking map at once by sweeping the cells grouped by height, from the top down.
+ *
+ * The rating of a cell is the sum of the ratings of its neighbours one height increment higher, with every ending
+ * position rated 1. The reachable ending positions are propagated the same way as bitsets, 64 ending positions per sweep,
+ * so the bitsets need one word per cell regardless of the number of ending positions.
+ * @param grid The hiking map, surrounded by a border of HEIGHT_MAP_BORDER.
+ * @param trail_head_value The height trails start at.
+ * @param stop_value The height trails end at.
+ * @param height_increment The increment for each step in height.
+ */
+class HikeTrailsDP
+{
+public:
+    HikeTrailsDP(const Grid<uint8_t> &grid, size_t trail_head_value, size_t stop_value, size_t height_increment);
+    size_t get_sum_rating_of_trailheads() const;
+    size_t get_sum_score_of_trailheads() const;
+
+private:
+    const Grid<uint8_t> &grid;
+    size_t height_increment;
+    std::vector<std::vector<size_t>> cells_by_height;
+    template <typename Function>
+    void for_each_higher_neighbour(size_t cell, Function &&function) const;
+};
+
+/**
+ * @class TrailheadEvaluator
+ * @brief Accumulates the score and rating of many trailheads with a DFS, reusing the same scratch buffer for every trailhead.
+ *
+ * Instead of a set of ending positions per trailhead, every ending position is stamped with the generation of the trailhead
+ * that reached it last, so a trailhead scores an ending position only the first time it stamps it. The trails are walked
+ * with an explicit stack that is reused as well. Each worker thread owns one evaluator and only the accumulated sums have
+ * to be combined afterwards.
+ * @param grid The hiking map, surrounded by a border of HEIGHT_MAP_BORDER.
+ * @param stop_value The target value to stop DFS.
+ * @param height_increment The increment for each step in height.
+ */
+class TrailheadEvaluator
+{
+public:
+    TrailheadEvaluator(const Grid<uint8_t> &grid, size_t stop_value, size_t height_increment);
+    void evaluate(size_t trail_head_index);
+    size_t get_score() const { return score; }
+    size_t get_rating() const { return rating; }
+
+private:
+    const Grid<uint8_t> &grid;
+    size_t stop_value, height_increment;
+    uint32_t generation;
+    std::vector<uint32_t> ending_stamps;
+    size_t score, rating;
+    DFSStack dfs_stack;
 };
 
 /**
  * @class Trailhead
  * @brief Represents a trailhead on the hiking map and provides scoring and rating methods.
- * @param map The hiking map as a 2D vector.
+ * @param map The hiking map, surrounded by a border of HEIGHT_MAP_BORDER.
  * @param starting_pos The starting position for the trailhead.
  * @param ending_height The target ending height for the trail.
  * @param height_increment The increment for each step in height.
@@ -81,13 +181,13 @@ private:
 class Trailhead
 {
 public:
-    Trailhead(const std::vector<std::vector<size_t>> &map, const Position &starting_pos, size_t ending_height, size_t height_increment);
-    size_t get_score();
-    size_t get_rating_of_trailheads();
+    Trailhead(const Grid<uint8_t> &map, const Position &starting_pos, size_t ending_height, size_t height_increment);
+    size_t get_score(DFSStack *dfs_stack = nullptr);
+    size_t get_rating_of_trailheads(DFSStack *dfs_stack = nullptr);
 
 private:
-    const std::vector<std::vector<size_t>> &map;
-    const Position &starting_pos;
+    const Grid<uint8_t> &map;
+    Position starting_pos;
     size_t ending_height, height_increment;
     HikeTrailsDFS hike_trails_dfs;
     std::unordered_set<Position> reachable_ending_positions;
@@ -96,37 +196,49 @@ private:
 /**
  * @class HikeGuide
  * @brief Manages all trailheads and provides aggregate scoring and rating methods.
- * @param map The hiking map as a 2D vector.
+ * @param map The hiking map, surrounded by a border of HEIGHT_MAP_BORDER. See create_height_map.
+ * @param number_of_threads Number of worker threads used by PARALLEL_TRAILHEAD_DFS (0 = hardware concurrency).
  */
 class HikeGuide
 {
 public:
-    HikeGuide(const std::vector<std::vector<size_t>> &map);
-    size_t get_score();
-    size_t get_sum_rating_of_all_trailheads();
+    HikeGuide(const Grid<uint8_t> &map, size_t number_of_threads = 1);
+    static Grid<uint8_t> create_height_map(const std::vector<std::vector<size_t>> &heights);
+    size_t get_score(TrailEngine trail_engine = TrailEngine::HEIGHT_DP);
+    size_t get_sum_rating_of_all_trailheads(TrailEngine trail_engine = TrailEngine::HEIGHT_DP);
 
 private:
-    const std::vector<std::vector<size_t>> &map;
+    const Grid<uint8_t> &map;
     std::vector<Trailhead> trail_heads;
+    std::vector<size_t> trail_head_indices;
+    HikeTrailsDP hike_trails_dp;
+    size_t number_of_threads;
     void find_trail_heads();
+    std::pair<size_t, size_t> evaluate_trail_heads_in_parallel() const;
+    TrailheadEvaluator evaluate_trail_heads(std::atomic<size_t> &next_trail_head) const;
 };
 
 /**
  * @class ManagerClass
  * @brief Handles reading the map from file and providing the score interface.
+ *
+ * The map is read and its trailheads are found once, and every query is answered from them. The score and rating of
+ * each engine are calculated on first use and cached, so queries can be repeated cheaply. Queries are not safe to run
+ * concurrently on the same ManagerClass.
  * @param input_file_name The path to the input file.
- * @param map The map as a 2D vector of size_t integers.
+ * @param number_of_threads Number of worker threads used by PARALLEL_TRAILHEAD_DFS (0 = hardware concurrency).
+ * @param map The map as a grid of heights.
  */
 class ManagerClass
 {
 public:
-    ManagerClass(const std::string &input_file_name);
-    size_t get_score();
-    size_t get_sum_rating_of_all_trailheads();
+    ManagerClass(const std::string &input_file_name, size_t number_of_threads = 1);
+    size_t get_score(TrailEngine trail_engine = TrailEngine::HEIGHT_DP);
+    size_t get_sum_rating_of_all_trailheads(TrailEngine trail_engine = TrailEngine::HEIGHT_DP);
 
 private:
-    std::vector<std::vector<size_t>> map;
+    Grid<uint8_t> map;
     HikeGuide hike_guide;
-    std::vector<std::vector<size_t>> read_input(const std::string &filename);
-    size_t convert_char_to_size_t(char c);
+    std::map<TrailEngine, size_t> scores, ratings;
+    Grid<uint8_t> read_input(const std::string &filename);
 };
\ No newline at end of file
@@ -1,28 +1,46 @@
 #include "hiking_guide.hpp"
+#include "batch.hpp"
+#include "instrumentation.hpp"
 
 /**
  * @brief Entry point. Runs the simulation and prints the results for part one and part two.
+ *
+ * Usage: hiking_guide [input_file]
+ *        hiking_guide --batch [--format=csv|json] [--workers=<n>] [--list=<file>] [<file or directory>...]
+ * The batch mode solves every input on a pool of workers and streams one result per input to stdout, see batch.hpp.
+ * Built with INSTRUMENTATION=1, the counters and phase timings are written to stderr as JSON.
  */
 int main(int argc, char *argv[])
 {
+    if (argc > 1 && std::string(argv[1]) == "--batch")
+    {
+        return batch::run_from_command_line(std::vector<std::string>(argv + 2, argv + argc), [](const std::string &filename)
+                                            {
+                                                ManagerClass manager(filename);
+                                                return batch::Answers{manager.get_score(), manager.get_sum_rating_of_all_trailheads()}; });
+    }
+
     std::cout << "Hiking Guide Simulation\n";
     std::cout << "==========================\n";
     std::string filename;
-    if (argc > 2)
+    if (argc > 1)
     {
         std::cout << "Filename provided: " << argv[1] << " \n";
         filename = argv[1];
     }
-    else if (argc < 2)
+    else
     {
         filename = "../puzzle_input";
         filename = "../small_puzzle_input";
         std::cout << "No input file provided. Using default filename " << filename << "\n";
     }
 
-    auto score = ManagerClass(filename).get_score();
+    ManagerClass manager(filename);
+    auto score = manager.get_score();
     std::cout << "Part One: " << score << std::endl << std::endl << std::endl;
 
-    auto sum = ManagerClass(filename).get_sum_rating_of_all_trailheads();
+    auto sum = manager.get_sum_rating_of_all_trailheads();
     std::cout << "Part Two: " << sum << "\n";
-}
\ No newline at end of file
+
+    instrumentation::write_json(std::cerr);
+}
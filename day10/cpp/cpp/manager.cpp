@@ -3,74 +3,57 @@
  * @brief Implements the ManagerClass for reading hiking map input and delegating scoring and rating logic.
  */
 #include "hiking_guide.hpp"
+#include "grid_file.hpp"
+#include "instrumentation.hpp"
+
+static instrumentation::Phase parse_phase("parse");
 
 /**
  * @brief Constructs a ManagerClass and reads the hiking map from file.
  * @param input_file_name The path to the input file.
+ * @param number_of_threads Number of worker threads used by PARALLEL_TRAILHEAD_DFS (0 = hardware concurrency).
  */
-ManagerClass::ManagerClass(const std::string &input_file_name)
-    : map(read_input(input_file_name)), hike_guide(map) {};
+ManagerClass::ManagerClass(const std::string &input_file_name, size_t number_of_threads)
+    : map(read_input(input_file_name)), hike_guide(map, number_of_threads) {};
 
 /**
  * @brief Reads the hiking map from the input file.
  *
- * Reads all non-whitespace characters from the file and returns them as a 2D vector of size_t integers.
+ * Maps the file into memory and converts its ASCII digits straight into a hiking map surrounded by a border of HEIGHT_MAP_BORDER.
  * @param filename The path to the input file.
- * @return A 2D vector of size_t integers representing the hiking map.
+ * @return The hiking map as a grid of heights.
  * @throws std::runtime_error if the file does not exist or is empty.
+ * @throws std::invalid_argument if the lines of the file differ in length.
  */
-std::vector<std::vector<size_t>> ManagerClass::read_input(const std::string &filename)
-{
-    std::vector<size_t> converted_line;
-    std::vector<std::vector<size_t>> hiking_map;
-    std::ifstream infile(filename);
-    if (!infile)
-        throw std::runtime_error("Error: The file " + filename + " does not exist.");
-
-    std::string line;
-    while (std::getline(infile, line))
-    {
-        if (!line.empty())
-        {
-            converted_line.reserve(line.size());
-            std::transform(line.begin(), line.end(), std::back_inserter(converted_line),
-                           [&](char c)
-                           { return convert_char_to_size_t(c); });
-
-            hiking_map.emplace_back(std::move(converted_line));
-        }
-    }
-    if (hiking_map.empty())
-    {
-        throw std::runtime_error("Error: The file " + filename + " is empty or invalid.");
-    }
-    return hiking_map;
-}
-
-/**
- * @brief Converts a character to its corresponding size_t value.
- * @param c The character to convert (ASCII digit).
- * @return The size_t integer value.
- */
-size_t ManagerClass::convert_char_to_size_t(char c)
+Grid<uint8_t> ManagerClass::read_input(const std::string &filename)
 {
-    return (size_t)c - 48;
+    instrumentation::ScopedTimer parse_timer(parse_phase);
+    return GridFile(filename).to_grid<uint8_t>(1, HEIGHT_MAP_BORDER, [](char c)
+                                               { return static_cast<uint8_t>(c - '0'); });
 }
 
 /**
- * @brief Returns the score calculated by the hiking guide.
+ * @brief Returns the score calculated by the hiking guide, calculated on the first call for each engine and cached.
+ * @param trail_engine The algorithm used for evaluating the trailheads.
  * @return The score as a size_t integer.
  */
-size_t ManagerClass::get_score()
+size_t ManagerClass::get_score(TrailEngine trail_engine)
 {
-    return hike_guide.get_score();
+    auto cached = scores.find(trail_engine);
+    if (cached == scores.end())
+        cached = scores.emplace(trail_engine, hike_guide.get_score(trail_engine)).first;
+    return cached->second;
 }
 
 /**
- * @brief Returns the sum of ratings for all trailheads as calculated by the hiking guide.
+ * @brief Returns the sum of ratings for all trailheads as calculated by the hiking guide, calculated on the first call for each engine and cached.
+ * @param trail_engine The algorithm used for evaluating the trailheads.
  * @return The sum of ratings as a size_t integer.
  */
-size_t ManagerClass::get_sum_rating_of_all_trailheads()
+size_t ManagerClass::get_sum_rating_of_all_trailheads(TrailEngine trail_engine)
 {
-    return hike_guide.get_sum_rating_of_all_trailheads();
+    auto cached = ratings.find(trail_engine);
+    if (cached == ratings.end())
+        cached = ratings.emplace(trail_engine, hike_guide.get_sum_rating_of_all_trailheads(trail_engine)).first;
+    return cached->second;
 }
\ No newline at end of file
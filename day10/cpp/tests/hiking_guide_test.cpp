@@ -5,8 +5,31 @@
 #include "gtest/gtest.h"
 // #include "gmock/gmock.h"
 #include <sstream>
+#include <random>
 #include "hiking_guide.hpp"
 
+/**
+ * @brief Generates a random hiking map with heights 0-9.
+ * @param rows The number of rows.
+ * @param cols The number of columns.
+ * @param seed The seed of the random number generator.
+ * @return The hiking map as a 2D vector.
+ */
+static std::vector<std::vector<size_t>> random_hiking_map(size_t rows, size_t cols, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<size_t> height(0, 9);
+    std::vector<std::vector<size_t>> map(rows, std::vector<size_t>(cols));
+    for (auto &row : map)
+    {
+        for (auto &value : row)
+        {
+            value = height(generator);
+        }
+    }
+    return map;
+}
+
 /**
  * @test GetScore
  * @brief Tests score, the number of unique ending positions in a hiking map.
@@ -14,7 +37,8 @@
 TEST(HikeGuideTest, GetScore)
 {   
     std::vector<std::vector<size_t>> map {{8,9,0,1,0,1,2,3,},{7,8,1,2,1,8,7,4,},{8,7,4,3,0,9,6,5,},{9,6,5,4,9,8,7,4,},{4,5,6,7,8,9,0,3,},{3,2,0,1,9,0,1,2,},{0,1,3,2,9,8,0,1,},{1,0,4,5,6,7,3,2,}};
-    HikeGuide hike_guide(map);
+    auto height_map = HikeGuide::create_height_map(map);
+    HikeGuide hike_guide(height_map);
     EXPECT_EQ(hike_guide.get_score(), 36);
 }
 
@@ -25,6 +49,123 @@ TEST(HikeGuideTest, GetScore)
 TEST(HikeGuideTest, SumOfRatingOfTrailheads)
 {   
     std::vector<std::vector<size_t>> map {{8,9,0,1,0,1,2,3,},{7,8,1,2,1,8,7,4,},{8,7,4,3,0,9,6,5,},{9,6,5,4,9,8,7,4,},{4,5,6,7,8,9,0,3,},{3,2,0,1,9,0,1,2,},{0,1,3,2,9,8,0,1,},{1,0,4,5,6,7,3,2,}};
-    HikeGuide hike_guide(map);
+    auto height_map = HikeGuide::create_height_map(map);
+    HikeGuide hike_guide(height_map);
     EXPECT_EQ(hike_guide.get_sum_rating_of_all_trailheads(), 81);
 }
+
+
+/**
+ * @test TrailEnginesAgree
+ * @brief Tests that the height DP gives the same score and rating as the trailhead DFS, for both example and random maps.
+ */
+TEST(HikeGuideTest, TrailEnginesAgree)
+{
+    std::vector<std::vector<size_t>> map {{8,9,0,1,0,1,2,3,},{7,8,1,2,1,8,7,4,},{8,7,4,3,0,9,6,5,},{9,6,5,4,9,8,7,4,},{4,5,6,7,8,9,0,3,},{3,2,0,1,9,0,1,2,},{0,1,3,2,9,8,0,1,},{1,0,4,5,6,7,3,2,}};
+    auto height_map = HikeGuide::create_height_map(map);
+    HikeGuide hike_guide(height_map);
+    EXPECT_EQ(hike_guide.get_score(TrailEngine::TRAILHEAD_DFS), 36);
+    EXPECT_EQ(hike_guide.get_sum_rating_of_all_trailheads(TrailEngine::TRAILHEAD_DFS), 81);
+
+    for (unsigned seed = 0; seed < 10; ++seed)
+    {
+        auto random_map = random_hiking_map(40, 33, seed);
+        auto random_height_map = HikeGuide::create_height_map(random_map);
+        HikeGuide random_hike_guide(random_height_map);
+        EXPECT_EQ(random_hike_guide.get_score(TrailEngine::HEIGHT_DP), random_hike_guide.get_score(TrailEngine::TRAILHEAD_DFS)) << "seed " << seed;
+        EXPECT_EQ(random_hike_guide.get_sum_rating_of_all_trailheads(TrailEngine::HEIGHT_DP), random_hike_guide.get_sum_rating_of_all_trailheads(TrailEngine::TRAILHEAD_DFS)) << "seed " << seed;
+    }
+}
+
+/**
+ * @test ParallelTrailheadDFSAgrees
+ * @brief Tests that the parallel trailhead DFS gives the same score and rating as the serial DFS, for any number of threads.
+ */
+TEST(HikeGuideTest, ParallelTrailheadDFSAgrees)
+{
+    std::vector<std::vector<size_t>> map {{8,9,0,1,0,1,2,3,},{7,8,1,2,1,8,7,4,},{8,7,4,3,0,9,6,5,},{9,6,5,4,9,8,7,4,},{4,5,6,7,8,9,0,3,},{3,2,0,1,9,0,1,2,},{0,1,3,2,9,8,0,1,},{1,0,4,5,6,7,3,2,}};
+    auto height_map = HikeGuide::create_height_map(map);
+    HikeGuide hike_guide(height_map, 4);
+    EXPECT_EQ(hike_guide.get_score(TrailEngine::PARALLEL_TRAILHEAD_DFS), 36);
+    EXPECT_EQ(hike_guide.get_sum_rating_of_all_trailheads(TrailEngine::PARALLEL_TRAILHEAD_DFS), 81);
+
+    auto random_map = random_hiking_map(120, 97, 7);
+    auto random_height_map = HikeGuide::create_height_map(random_map);
+    HikeGuide serial_hike_guide(random_height_map);
+    size_t score = serial_hike_guide.get_score(TrailEngine::TRAILHEAD_DFS);
+    size_t rating = serial_hike_guide.get_sum_rating_of_all_trailheads(TrailEngine::TRAILHEAD_DFS);
+    for (size_t number_of_threads : {1, 3, 8})
+    {
+        HikeGuide parallel_hike_guide(random_height_map, number_of_threads);
+        EXPECT_EQ(parallel_hike_guide.get_score(TrailEngine::PARALLEL_TRAILHEAD_DFS), score) << number_of_threads << " threads";
+        EXPECT_EQ(parallel_hike_guide.get_sum_rating_of_all_trailheads(TrailEngine::PARALLEL_TRAILHEAD_DFS), rating) << number_of_threads << " threads";
+    }
+}
+
+/**
+ * @test IterativeDFSMatchesRecursiveDFS
+ * @brief Tests that the iterative DFS finds the same ending positions and ratings as the recursive DFS, reusing one stack.
+ */
+TEST(HikeTrailsDFSTest, IterativeDFSMatchesRecursiveDFS)
+{
+    auto random_map = random_hiking_map(60, 45, 3);
+    auto height_map = HikeGuide::create_height_map(random_map);
+    DFSStack dfs_stack;
+    height_map.for_each_index([&](size_t index)
+                              {
+        if (height_map[index] != 0)
+            return;
+        Position trail_head(height_map.get_col(index), height_map.get_row(index), 0);
+        HikeTrailsDFS recursive(height_map, 9, 1);
+        HikeTrailsDFS iterative(height_map, 9, 1);
+        EXPECT_EQ(iterative.get_reachable_ending_positions(trail_head, &dfs_stack), recursive.get_reachable_ending_positions(trail_head));
+        EXPECT_EQ(iterative.get_rating_of_trailheads(trail_head, &dfs_stack), recursive.get_rating_of_trailheads(trail_head)); });
+
+    std::vector<std::vector<size_t>> tall_map(1);
+    for (size_t height = 0; height < 250; ++height)
+    {
+        tall_map[0].push_back(height);
+    }
+    auto tall_height_map = HikeGuide::create_height_map(tall_map);
+    HikeTrailsDFS tall_trail(tall_height_map, 249, 1);
+    EXPECT_EQ(tall_trail.get_rating_of_trailheads(Position(0, 0, 0), &dfs_stack).at(Position(249, 0, 249)), 1);
+
+    std::vector<std::vector<size_t>> map {{8,9,0,1,0,1,2,3,},{7,8,1,2,1,8,7,4,},{8,7,4,3,0,9,6,5,},{9,6,5,4,9,8,7,4,},{4,5,6,7,8,9,0,3,},{3,2,0,1,9,0,1,2,},{0,1,3,2,9,8,0,1,},{1,0,4,5,6,7,3,2,}};
+    auto example_height_map = HikeGuide::create_height_map(map);
+    HikeGuide hike_guide(example_height_map);
+    EXPECT_EQ(hike_guide.get_score(TrailEngine::ITERATIVE_TRAILHEAD_DFS), 36);
+    EXPECT_EQ(hike_guide.get_sum_rating_of_all_trailheads(TrailEngine::ITERATIVE_TRAILHEAD_DFS), 81);
+}
+
+/**
+ * @test HeightDPScoresMoreThan64EndingPositions
+ * @brief Tests that the score spans several bitset sweeps when the map has more than 64 ending positions.
+ */
+TEST(HikeGuideTest, HeightDPScoresMoreThan64EndingPositions)
+{
+    // 100 rows that each hold a single trail 0-9, next to a column the trails cannot step onto.
+    std::vector<std::vector<size_t>> map(100, std::vector<size_t>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 5});
+    auto height_map = HikeGuide::create_height_map(map);
+    HikeTrailsDP hike_trails_dp(height_map, 0, 9, 1);
+    EXPECT_EQ(hike_trails_dp.get_sum_score_of_trailheads(), 100);
+    EXPECT_EQ(hike_trails_dp.get_sum_rating_of_trailheads(), 100);
+    EXPECT_THROW(HikeTrailsDP(height_map, 0, 9, 0), std::invalid_argument);
+    EXPECT_THROW(HikeTrailsDP(Grid<uint8_t>(map), 0, 9, 1), std::invalid_argument);
+}
+
+/**
+ * @test ManagerClassAnswersRepeatedQueries
+ * @brief Tests that a single ManagerClass answers both parts, with every engine, and repeated queries.
+ */
+TEST(ManagerClassTest, ManagerClassAnswersRepeatedQueries)
+{
+    ManagerClass manager("../small_puzzle_input", 2);
+    EXPECT_EQ(manager.get_score(), 36);
+    EXPECT_EQ(manager.get_sum_rating_of_all_trailheads(), 81);
+    for (auto trail_engine : {TrailEngine::TRAILHEAD_DFS, TrailEngine::ITERATIVE_TRAILHEAD_DFS, TrailEngine::PARALLEL_TRAILHEAD_DFS})
+    {
+        EXPECT_EQ(manager.get_score(trail_engine), 36);
+        EXPECT_EQ(manager.get_sum_rating_of_all_trailheads(trail_engine), 81);
+    }
+    EXPECT_EQ(manager.get_score(), 36);
+}
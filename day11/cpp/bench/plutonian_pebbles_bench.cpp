@@ -0,0 +1,67 @@
+#include "bench.hpp"
+#include "plutonian_pebbles.hpp"
+
+/**
+ * @brief Generates a line of stones with random engraved numbers below one million.
+ * @param number_of_stones The number of stones in the line.
+ */
+std::vector<size_t> generate_stones(bench::Generator &generator, size_t number_of_stones)
+{
+    std::vector<size_t> stones(number_of_stones);
+    for (auto &stone : stones)
+    {
+        stone = generator.uniform(0, 999999);
+    }
+    return stones;
+}
+
+/**
+ * @brief Formats a line of stones like the puzzle input.
+ */
+std::string format_stones(const std::vector<size_t> &stones)
+{
+    std::string line;
+    for (auto stone : stones)
+    {
+        line += (line.empty() ? "" : " ") + std::to_string(stone);
+    }
+    return line + "\n";
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        bench::Suite suite("Plutonian Pebbles", argc, argv);
+        bench::Generator generator;
+        for (size_t number_of_stones : {8 * suite.get_scale(), 256 * suite.get_scale()})
+        {
+            std::string label = std::to_string(number_of_stones);
+            std::vector<size_t> starting_pebble_order = generate_stones(generator, number_of_stones);
+            std::string filename = bench::write_input("build/bench_stones_" + label, format_stones(starting_pebble_order));
+            // The cache rows count the same in-memory stones as the transformer rows, parsed once up front
+            auto starting_pebble_counts = ManagerClass(filename).get_starting_pebble_counts();
+
+            for (size_t number_of_blinks : {25, 75})
+            {
+                std::string group = "blinks=" + std::to_string(number_of_blinks) + "@" + label;
+                suite.run(group + "/transformer", [&]
+                          { return PlutonianPebbleTransformer(starting_pebble_order).get_number_of_pebbles_after_blinking(number_of_blinks); });
+                suite.run(group + "/parallel_transformer", [&]
+                          { return PlutonianPebbleTransformer(starting_pebble_order).get_number_of_pebbles_after_blinking_in_parallel(number_of_blinks, 0); });
+                suite.run(group + "/cold_cache", [&]
+                          { PebbleCountCache cache;
+                            return cache.get_number_of_pebbles_in_parallel(starting_pebble_counts, number_of_blinks, 1); });
+                PebbleCountCache warm_cache;
+                suite.run(group + "/warm_cache", [&]
+                          { return warm_cache.get_number_of_pebbles_in_parallel(starting_pebble_counts, number_of_blinks, 1); });
+            }
+        }
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
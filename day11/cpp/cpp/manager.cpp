@@ -3,13 +3,40 @@
  * @brief Implements the ManagerClass for plutonian pebbles input and delegating pebble changing logic.
  */
 #include "plutonian_pebbles.hpp"
+#include "instrumentation.hpp"
+
+static instrumentation::Phase parse_phase("parse");
+static instrumentation::Phase compute_phase("compute");
 
 /**
- * @brief Constructs a ManagerClass and reads the hiking map from file.
+ * @brief Constructs a ManagerClass and reads the pebble order from file.
  * @param input_file_name The path to the input file.
+ * @param number_of_threads Number of threads counting the pebbles (0 = hardware concurrency).
+ * @param cache The pebble count cache used with more than one thread, the process-wide cache by default.
  */
-ManagerClass::ManagerClass(const std::string &input_file_name)
-    : starting_pebble_order(read_input(input_file_name)) {};
+ManagerClass::ManagerClass(const std::string &input_file_name, size_t number_of_threads, PebbleCountCache &cache)
+    : starting_pebble_order(read_input(input_file_name)), starting_pebble_counts(count_starting_pebbles()),
+      transformer(starting_pebble_order),
+      number_of_threads(number_of_threads != 0 ? number_of_threads : std::max(1u, std::thread::hardware_concurrency())),
+      cache(cache) {};
+
+/**
+ * @brief Counts how often every engraved number occurs in the starting pebble order.
+ * @return Pairs of engraved number and number of occurrences, in order of first occurrence.
+ */
+std::vector<std::pair<size_t, size_t>> ManagerClass::count_starting_pebbles() const
+{
+    std::vector<std::pair<size_t, size_t>> counts;
+    std::unordered_map<size_t, size_t> index_by_engraved_number;
+    for (auto engraved_number : starting_pebble_order)
+    {
+        auto [it, inserted] = index_by_engraved_number.try_emplace(engraved_number, counts.size());
+        if (inserted)
+            counts.emplace_back(engraved_number, 0);
+        ++counts[it->second].second;
+    }
+    return counts;
+}
 
 /**
  * @brief Reads the starting pebble order from the input file.
@@ -21,6 +48,7 @@ ManagerClass::ManagerClass(const std::string &input_file_name)
  */
 std::vector<size_t> ManagerClass::read_input(const std::string &filename)
 {
+    instrumentation::ScopedTimer parse_timer(parse_phase);
     std::vector<size_t> order;
     std::ifstream infile(filename);
     if (!infile)
@@ -43,11 +71,48 @@ std::vector<size_t> ManagerClass::read_input(const std::string &filename)
 }
 
 /**
- * @brief Returns the number of pebbles after blinking calculated by the plutonian pebble transformer.
+ * @brief Returns the number of pebbles after blinking.
+ *
+ * On a single thread the pebbles are counted by engraved number, one blink at a time. With more threads the
+ * distinct starting pebbles are counted by number_of_threads workers sharing the pebble count cache.
+ * The result is calculated on the first call for each number of blinks, later calls return the cached value.
+ * @param number_of_blinks The number of blinks to apply.
  * @return The number of pebbles as a size_t integer.
+ * @throws std::overflow_error if an engraved number or the number of pebbles overflows.
  */
 size_t ManagerClass::get_number_of_pebbles(size_t number_of_blinks)
 {
-    PlutonianPebbleTransformer pebble_transformer(starting_pebble_order);
-    return pebble_transformer.get_number_of_pebbles_after_blinking(number_of_blinks);
+    auto cached = number_of_pebbles_by_blinks.find(number_of_blinks);
+    if (cached != number_of_pebbles_by_blinks.end())
+        return cached->second;
+
+    instrumentation::ScopedTimer compute_timer(compute_phase);
+    size_t number_of_pebbles = number_of_threads == 1
+                                   ? transformer.get_number_of_pebbles_after_blinking(number_of_blinks)
+                                   : cache.get_number_of_pebbles_in_parallel(starting_pebble_counts, number_of_blinks, number_of_threads);
+    number_of_pebbles_by_blinks.emplace(number_of_blinks, number_of_pebbles);
+    return number_of_pebbles;
+}
+
+/**
+ * @brief Returns the number of pebbles for every number of blinks in a range.
+ *
+ * The deepest query is computed first. With more than one thread it caches the results for all shallower
+ * depths in the pebble count cache, so the remaining depths become cache lookups.
+ * @param min_number_of_blinks The smallest number of blinks to report.
+ * @param max_number_of_blinks The largest number of blinks to report.
+ * @return The number of pebbles for each number of blinks from min_number_of_blinks to max_number_of_blinks.
+ * @throws std::invalid_argument if the range is empty.
+ */
+std::vector<size_t> ManagerClass::get_number_of_pebbles_for_blinks(size_t min_number_of_blinks, size_t max_number_of_blinks)
+{
+    if (min_number_of_blinks > max_number_of_blinks)
+        throw std::invalid_argument("Minimum number of blinks is larger than maximum number of blinks.");
+
+    std::vector<size_t> number_of_pebbles(max_number_of_blinks - min_number_of_blinks + 1);
+    for (size_t number_of_blinks = max_number_of_blinks + 1; number_of_blinks-- > min_number_of_blinks;)
+    {
+        number_of_pebbles[number_of_blinks - min_number_of_blinks] = get_number_of_pebbles(number_of_blinks);
+    }
+    return number_of_pebbles;
 }
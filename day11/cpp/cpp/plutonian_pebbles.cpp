@@ -1,4 +1,35 @@
 #include "plutonian_pebbles.hpp"
+#include "instrumentation.hpp"
+#include <array>
+#include <bit>
+
+static instrumentation::Counter splits_performed("splits_performed");
+static instrumentation::Counter cache_hits("cache_hits");
+static instrumentation::Counter hash_inserts("hash_inserts");
+
+/**
+ * @brief Adds two numbers of pebbles.
+ * @throws std::overflow_error if the sum does not fit into a size_t.
+ */
+static size_t add_pebble_counts(size_t number_of_pebbles, size_t more_pebbles)
+{
+    size_t sum;
+    if (__builtin_add_overflow(number_of_pebbles, more_pebbles, &sum))
+        throw std::overflow_error("Number of pebbles overflows a size_t.");
+    return sum;
+}
+
+/**
+ * @brief Multiplies the number of pebbles one pebble turns into by how often that pebble occurs.
+ * @throws std::overflow_error if the product does not fit into a size_t.
+ */
+static size_t multiply_pebble_counts(size_t number_of_pebbles, size_t occurrences)
+{
+    size_t product;
+    if (__builtin_mul_overflow(number_of_pebbles, occurrences, &product))
+        throw std::overflow_error("Number of pebbles overflows a size_t.");
+    return product;
+}
 
 PlutonianPebbleTransformer::PlutonianPebbleTransformer(const std::vector<size_t> &starting_pebble_order)
     : current_pebble_order(convert_integers_to_pebbles(std::move(starting_pebble_order))) {};
@@ -22,7 +53,122 @@ void PlutonianPebbleTransformer::print_pebbles()
     std::cout << std::endl;
 }
 
+/**
+ * @brief Counts the pebbles after blinking, tracking how many pebbles carry each engraved number.
+ *
+ * Memory is proportional to the number of distinct engraved numbers rather than the number of pebbles.
+ * The current pebble order is left untouched.
+ * @param number_of_blinks The number of blinks to apply.
+ * @return The number of pebbles as a size_t integer.
+ * @throws std::overflow_error if an engraved number or the number of pebbles overflows.
+ */
 size_t PlutonianPebbleTransformer::get_number_of_pebbles_after_blinking(size_t number_of_blinks)
+{
+    auto pebble_counts = count_pebbles_by_engraved_number();
+    BlinkBuffers buffers;
+    while (number_of_blinks--)
+    {
+        blink_pebble_counts(pebble_counts, buffers);
+    }
+
+    size_t number_of_pebbles = 0;
+    for (const auto &pebble_count : pebble_counts)
+    {
+        number_of_pebbles = add_pebble_counts(number_of_pebbles, pebble_count.second);
+    }
+    return number_of_pebbles;
+}
+
+/**
+ * @brief Counts the pebbles after blinking, evaluating the subtrees of distinct engraved numbers on a pool of workers.
+ *
+ * The pebble counts are first blinked on the calling thread until they hold a few distinct engraved numbers per
+ * worker, the frontier, so even a single starting pebble is split into enough tasks. Every engraved number of the
+ * frontier is then counted as its own task, with all workers sharing one lock-striped cache of
+ * (engraved number, remaining blinks) results, and the counts are summed at the end.
+ * The current pebble order is left untouched.
+ * @param number_of_blinks The number of blinks to apply.
+ * @param number_of_threads Number of worker threads (0 = hardware concurrency).
+ * @return The number of pebbles as a size_t integer.
+ * @throws std::overflow_error if an engraved number or the number of pebbles overflows.
+ */
+size_t PlutonianPebbleTransformer::get_number_of_pebbles_after_blinking_in_parallel(size_t number_of_blinks, size_t number_of_threads)
+{
+    const size_t tasks_per_worker = 8;
+    if (number_of_threads == 0)
+        number_of_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    auto pebble_counts = count_pebbles_by_engraved_number();
+    BlinkBuffers buffers;
+    for (; number_of_blinks > 0 && pebble_counts.size() < number_of_threads * tasks_per_worker; --number_of_blinks)
+    {
+        blink_pebble_counts(pebble_counts, buffers);
+    }
+
+    PebbleCountCache cache;
+    return cache.get_number_of_pebbles_in_parallel({pebble_counts.begin(), pebble_counts.end()}, number_of_blinks, number_of_threads);
+}
+
+/**
+ * @brief Applies one blink to pebble counts grouped by engraved number.
+ * @param pebble_counts The number of pebbles per engraved number, replaced by the counts after the blink.
+ * @param buffers Scratch buffers, reused from one blink to the next.
+ */
+void PlutonianPebbleTransformer::blink_pebble_counts(std::unordered_map<size_t, size_t> &pebble_counts, BlinkBuffers &buffers)
+{
+    auto &[next_pebble_counts, engraved_numbers, split_off_numbers, counts] = buffers;
+    engraved_numbers.clear();
+    counts.clear();
+    for (const auto &[engraved_number, count] : pebble_counts)
+    {
+        engraved_numbers.push_back(engraved_number);
+        counts.push_back(count);
+    }
+    split_off_numbers.resize(engraved_numbers.size());
+    PlutonianPebble::apply_rule_to_numbers(engraved_numbers, split_off_numbers);
+
+    next_pebble_counts.clear();
+    next_pebble_counts.reserve(pebble_counts.size() * 2);
+    size_t splits = 0;
+    for (size_t idx = 0; idx < engraved_numbers.size(); ++idx)
+    {
+        size_t &count = next_pebble_counts[engraved_numbers[idx]];
+        count = add_pebble_counts(count, counts[idx]);
+        if (split_off_numbers[idx] != PlutonianPebble::NO_SPLIT)
+        {
+            ++splits;
+            size_t &split_off_count = next_pebble_counts[split_off_numbers[idx]];
+            split_off_count = add_pebble_counts(split_off_count, counts[idx]);
+        }
+    }
+    splits_performed.add(splits);
+    std::swap(pebble_counts, next_pebble_counts);
+}
+
+/**
+ * @brief Groups the current pebble order by engraved number.
+ * @return A map from engraved number to the number of pebbles carrying it.
+ */
+std::unordered_map<size_t, size_t> PlutonianPebbleTransformer::count_pebbles_by_engraved_number()
+{
+    std::unordered_map<size_t, size_t> pebble_counts;
+    for (const auto &pebble : current_pebble_order)
+    {
+        ++pebble_counts[pebble.engraved_number];
+    }
+    return pebble_counts;
+}
+
+/**
+ * @brief Blinks the ordered line of pebbles and returns the resulting order.
+ *
+ * Every pebble is kept as its own object in line order, so memory grows with the number of pebbles.
+ * Only use this when the order itself is needed; get_number_of_pebbles_after_blinking is much cheaper for counting.
+ * The current pebble order is advanced by the number of blinks.
+ * @param number_of_blinks The number of blinks to apply.
+ * @return The engraved numbers of the pebbles in line order.
+ */
+std::vector<size_t> PlutonianPebbleTransformer::get_pebble_order_after_blinking(size_t number_of_blinks)
 {
 
     while (number_of_blinks--)
@@ -48,13 +194,14 @@ size_t PlutonianPebbleTransformer::get_number_of_pebbles_after_blinking(size_t n
             ++offset;
         }
     }
-    return current_pebble_order.size();
-    size_t sum = 0;
-    for (auto &pebble : current_pebble_order)
+
+    std::vector<size_t> pebble_order;
+    pebble_order.reserve(current_pebble_order.size());
+    for (const auto &pebble : current_pebble_order)
     {
-        sum += pebble.engraved_number;
+        pebble_order.push_back(pebble.engraved_number);
     }
-    return sum;
+    return pebble_order;
 }
 
 PlutonianPebble::PlutonianPebble(size_t engraved_number) : engraved_number(engraved_number) {};
@@ -72,78 +219,329 @@ std::ostream &operator<<(std::ostream &os, const PlutonianPebble &pebble)
     return os;
 }
 
+/**
+ * @brief Applies the pebble rule to this pebble.
+ *
+ * A pebble that splits keeps the right half of its digits and the left half is returned as a new pebble.
+ * @return The new pebble to insert before this pebble, or std::nullopt if the pebble did not split.
+ * @throws std::overflow_error if multiplying the engraved number by 2024 overflows.
+ */
 std::optional<PlutonianPebble> PlutonianPebble::apply_plutonian_pebble_rule()
 {
     // std::cout << "Apply rule on number " << engraved_number << std::endl;
-    if (engraved_number == 0)
+    auto split_off_number = apply_rule_to_number(engraved_number);
+    if (split_off_number == NO_SPLIT)
     {
-        engraved_number = 1;
         return std::nullopt;
     }
+    return PlutonianPebble(split_off_number);
+}
 
-    auto number_of_digits = std::to_string(engraved_number).size();
+/**
+ * @brief Returns 10^n for all n representable in size_t.
+ */
+static constexpr std::array<size_t, 20> powers_of_ten = []()
+{
+    std::array<size_t, 20> powers{};
+    size_t power = 1;
+    for (auto &p : powers)
+    {
+        p = power;
+        power *= 10;
+    }
+    return powers;
+}();
 
+/**
+ * @brief Counts the decimal digits of a number without converting it to a string.
+ *
+ * Estimates the digit count from the bit width (log10(2) ~= 1233/4096) and corrects it with the power-of-ten table.
+ * Setting the lowest bit maps 0 to 1 and never changes the digit count of any other number.
+ * @param number The number to count the digits of.
+ * @return The number of digits, 1 for 0.
+ */
+size_t PlutonianPebble::count_digits(size_t number)
+{
+    number |= 1;
+    size_t estimate = (std::bit_width(number) * 1233) >> 12;
+    return estimate + 1 - (number < powers_of_ten[estimate]);
+}
+
+/**
+ * @brief Applies the pebble rule to an engraved number.
+ *
+ * - 0 becomes 1.
+ * - A number with an even number of digits is split in two with div/mod, the right half stays engraved.
+ * - Any other number is multiplied by 2024.
+ * @param engraved_number The engraved number, updated in place.
+ * @return The left half of a split number, or NO_SPLIT if the number did not split.
+ * @throws std::overflow_error if multiplying the engraved number by 2024 overflows.
+ */
+size_t PlutonianPebble::apply_rule_to_number(size_t &engraved_number)
+{
+    if (engraved_number == 0)
+    {
+        engraved_number = 1;
+        return NO_SPLIT;
+    }
+
+    auto number_of_digits = count_digits(engraved_number);
     if (number_of_digits % 2 == 0)
     {
-        auto separated_numbers = get_separated_numbers(number_of_digits);
-        engraved_number = separated_numbers.second;
-        return PlutonianPebble(separated_numbers.first);
+        const size_t half = powers_of_ten[number_of_digits / 2];
+        const size_t left = engraved_number / half;
+        engraved_number %= half;
+        return left;
+    }
+
+    if (engraved_number > std::numeric_limits<size_t>::max() / 2024)
+    {
+        throw std::overflow_error("Engraved number " + std::to_string(engraved_number) + " overflows when multiplied by 2024.");
     }
     engraved_number *= 2024;
-    return std::nullopt;
+    return NO_SPLIT;
 }
 
-std::pair<size_t, size_t> PlutonianPebble::get_separated_numbers(size_t number_of_digits)
+/**
+ * @brief Applies the pebble rule to a contiguous array of engraved numbers.
+ *
+ * The loop body is free of allocations and calls, so the whole array is processed in one tight pass. Overflows are
+ * checked in a cheaper pass before it, so both arrays are left untouched if the rule cannot be applied.
+ * @param engraved_numbers The engraved numbers, updated in place.
+ * @param split_off_numbers Receives the left half of each split number, or NO_SPLIT. Must be as large as engraved_numbers.
+ * @throws std::invalid_argument if the arrays differ in size.
+ * @throws std::overflow_error if multiplying an engraved number by 2024 overflows.
+ */
+void PlutonianPebble::apply_rule_to_numbers(std::span<size_t> engraved_numbers, std::span<size_t> split_off_numbers)
 {
+    if (engraved_numbers.size() != split_off_numbers.size())
+    {
+        throw std::invalid_argument("Engraved and split off numbers must have the same size.");
+    }
 
-    // Update this pebble with last digits of engraved_number and create new pebble with the first digits.
-    std::pair<size_t, size_t> number_pair;
-    // std::cout << "Get separated numbers for " << engraved_number << std::endl;
-
-    number_pair.first = convert_to_integer(std::to_string(engraved_number).substr(0, number_of_digits / 2));
+    // Only numbers above the limit can overflow, and only those that do not split
+    constexpr size_t largest_multipliable_number = std::numeric_limits<size_t>::max() / 2024;
+    bool any_large_number = false;
+    for (const size_t number : engraved_numbers)
+    {
+        any_large_number |= number > largest_multipliable_number;
+    }
+    if (any_large_number)
+    {
+        for (const size_t number : engraved_numbers)
+        {
+            if (number > largest_multipliable_number && count_digits(number) % 2 != 0)
+                throw std::overflow_error("Engraved number " + std::to_string(number) + " overflows when multiplied by 2024.");
+        }
+    }
 
-    auto new_pebble_number_2 = std::to_string(engraved_number).substr(number_of_digits / 2, number_of_digits / 2);
-    if (new_pebble_number_2.length() == 1)
+    for (size_t idx = 0; idx < engraved_numbers.size(); ++idx)
     {
-        number_pair.second = convert_to_integer(new_pebble_number_2);
-        return number_pair;
+        const size_t number = engraved_numbers[idx];
+        const size_t number_of_digits = count_digits(number);
+        const bool split = number != 0 && number_of_digits % 2 == 0;
+        const size_t half = powers_of_ten[number_of_digits / 2];
+
+        split_off_numbers[idx] = split ? number / half : NO_SPLIT;
+        engraved_numbers[idx] = number == 0 ? 1 : (split ? number % half : number * 2024);
     }
+}
 
-    // Remove all zeros at the start of the number
-    number_pair.second = remove_leading_zeros(new_pebble_number_2);
-    /* for (size_t index = 0; index < new_pebble_number_2.length(); index++)
+/**
+ * @brief Equality operator for PebbleCountKey.
+ * @param other The other PebbleCountKey to compare.
+ * @return True if engraved number and remaining blinks are equal.
+ */
+bool PebbleCountKey::operator==(const PebbleCountKey &other) const
+{
+    return engraved_number == other.engraved_number && remaining_blinks == other.remaining_blinks;
+}
+
+/**
+ * @brief Returns the cache shared by the whole process.
+ * @return The shared PebbleCountCache.
+ */
+PebbleCountCache &PebbleCountCache::shared()
+{
+    static PebbleCountCache cache;
+    return cache;
+}
+
+/**
+ * @brief Returns the number of pebbles a single pebble turns into after blinking, using cached results where possible.
+ *
+ * Every intermediate (engraved number, remaining blinks) result is cached as well,
+ * so a query for n blinks makes all queries for fewer blinks on the same pebbles cheap.
+ * @param engraved_number The engraved number of the pebble.
+ * @param remaining_blinks The number of blinks to apply.
+ * @return The number of pebbles as a size_t integer.
+ * @throws std::overflow_error if an engraved number or the number of pebbles overflows.
+ */
+size_t PebbleCountCache::get_number_of_pebbles(size_t engraved_number, size_t remaining_blinks)
+{
+    CountEvents events;
+    size_t number_of_pebbles = count_pebbles(engraved_number, remaining_blinks, events);
+    events.add_to_counters();
+    return number_of_pebbles;
+}
+
+/**
+ * @brief Returns the total number of pebbles many groups of equal pebbles turn into, counting the groups on a pool of workers.
+ *
+ * The groups are claimed one at a time from a shared counter, since the cost of a group depends on how much of its
+ * subtree other workers have cached already. Every worker sums its own groups and the sums are added up after joining.
+ * @param pebble_counts Pairs of engraved number and number of pebbles carrying it.
+ * @param remaining_blinks The number of blinks to apply.
+ * @param number_of_threads Number of worker threads (0 = hardware concurrency).
+ * @return The number of pebbles as a size_t integer.
+ * @throws std::overflow_error if an engraved number or the number of pebbles overflows.
+ */
+size_t PebbleCountCache::get_number_of_pebbles_in_parallel(const std::vector<std::pair<size_t, size_t>> &pebble_counts, size_t remaining_blinks, size_t number_of_threads)
+{
+    if (number_of_threads == 0)
+        number_of_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::atomic<size_t> next_pebble_count{0};
+    auto count_claimed_pebbles = [&]()
     {
-        if (new_pebble_number_2[index] != '0')
+        size_t number_of_pebbles = 0;
+        size_t idx;
+        CountEvents events;
+        while ((idx = next_pebble_count.fetch_add(1)) < pebble_counts.size())
         {
-            auto substring_test = new_pebble_number_2.substr(index);
-            number_pair.second = convert_to_integer(substring_test);
-            break;
+            const auto &[engraved_number, occurrences] = pebble_counts[idx];
+            number_of_pebbles = add_pebble_counts(number_of_pebbles, multiply_pebble_counts(count_pebbles(engraved_number, remaining_blinks, events), occurrences));
         }
+        events.add_to_counters();
+        return number_of_pebbles;
+    };
+
+    size_t workers = std::min(number_of_threads, pebble_counts.size());
+    if (workers <= 1)
+        return count_claimed_pebbles();
+
+    std::vector<size_t> pebbles_per_worker(workers, 0);
+    std::vector<std::exception_ptr> errors(workers);
+    std::vector<std::thread> threads;
+    threads.reserve(workers);
+    for (size_t worker = 0; worker < workers; ++worker)
+    {
+        threads.emplace_back([&, worker]()
+                             {
+            try
+            {
+                pebbles_per_worker[worker] = count_claimed_pebbles();
+            }
+            catch (...)
+            {
+                errors[worker] = std::current_exception();
+                next_pebble_count = pebble_counts.size();
+            } });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    for (const auto &error : errors)
+    {
+        if (error)
+            std::rethrow_exception(error);
     }
-    if (!number_pair.second)
-        number_pair.second = 0; */
 
-    return number_pair;
+    size_t number_of_pebbles = 0;
+    for (auto worker_pebbles : pebbles_per_worker)
+    {
+        number_of_pebbles = add_pebble_counts(number_of_pebbles, worker_pebbles);
+    }
+    return number_of_pebbles;
 }
 
-size_t PlutonianPebble::convert_to_integer(const std::string &str)
+/**
+ * @brief Returns the number of cached results.
+ * @return The number of cached (engraved number, remaining blinks) entries.
+ */
+size_t PebbleCountCache::size()
 {
-    return stoull(str);
-    // std::cout << "Before converting to int " << str << std::endl;
-    size_t my_new_int;
-    std::stringstream tmp_stream(str);
-    tmp_stream >> my_new_int;
-    // std::cout << "After converting to int " << my_new_int << std::endl;
-    return my_new_int;
+    size_t number_of_results = 0;
+    for (auto &stripe : stripes)
+    {
+        std::lock_guard<std::mutex> lock(stripe.stripe_mutex);
+        number_of_results += stripe.pebble_counts.size();
+    }
+    return number_of_results;
 }
 
-size_t PlutonianPebble::remove_leading_zeros(const std::string &str)
+/**
+ * @brief Removes all cached results.
+ */
+void PebbleCountCache::clear()
 {
-    size_t first_non_zero = str.find_first_not_of('0');
-    if (first_non_zero == std::string::npos)
+    for (auto &stripe : stripes)
     {
-        // All characters are '0'
-        return 0;
+        std::lock_guard<std::mutex> lock(stripe.stripe_mutex);
+        stripe.pebble_counts.clear();
     }
-    return convert_to_integer(str.substr(first_non_zero));
+}
+
+/**
+ * @brief Returns the stripe holding the result of a key, chosen by the upper bits of its hash.
+ *
+ * The maps inside a stripe pick their buckets by the lower bits, so both stay evenly spread.
+ */
+PebbleCountCache::Stripe &PebbleCountCache::get_stripe(const PebbleCountKey &key)
+{
+    return stripes[(std::hash<PebbleCountKey>()(key) >> 32) % number_of_stripes];
+}
+
+/**
+ * @brief Recursively counts the pebbles a pebble turns into, filling the cache on the way.
+ *
+ * The recursion depth equals the number of remaining blinks. The stripe of a result is only locked to look it up
+ * and to insert it, so the recursion never holds a lock.
+ * @param engraved_number The engraved number of the pebble.
+ * @param remaining_blinks The number of blinks to apply.
+ * @param events The instrumentation events of the calling worker, counted without touching the shared counters.
+ * @return The number of pebbles as a size_t integer.
+ * @throws std::overflow_error if an engraved number or the number of pebbles overflows.
+ */
+size_t PebbleCountCache::count_pebbles(size_t engraved_number, size_t remaining_blinks, CountEvents &events)
+{
+    if (remaining_blinks == 0)
+        return 1;
+
+    PebbleCountKey key{engraved_number, remaining_blinks};
+    Stripe &stripe = get_stripe(key);
+    {
+        std::lock_guard<std::mutex> lock(stripe.stripe_mutex);
+        auto it = stripe.pebble_counts.find(key);
+        if (it != stripe.pebble_counts.end())
+        {
+            ++events.cache_hits;
+            return it->second;
+        }
+    }
+
+    size_t next_engraved_number = engraved_number;
+    size_t split_off_number = PlutonianPebble::apply_rule_to_number(next_engraved_number);
+    size_t number_of_pebbles = count_pebbles(next_engraved_number, remaining_blinks - 1, events);
+    if (split_off_number != PlutonianPebble::NO_SPLIT)
+    {
+        ++events.splits;
+        number_of_pebbles = add_pebble_counts(number_of_pebbles, count_pebbles(split_off_number, remaining_blinks - 1, events));
+    }
+
+    std::lock_guard<std::mutex> lock(stripe.stripe_mutex);
+    if (stripe.pebble_counts.emplace(key, number_of_pebbles).second)
+        ++events.hash_inserts;
+    return number_of_pebbles;
+}
+
+/**
+ * @brief Adds the events of a count to the shared instrumentation counters.
+ */
+void PebbleCountCache::CountEvents::add_to_counters() const
+{
+    ::cache_hits.add(cache_hits);
+    splits_performed.add(splits);
+    ::hash_inserts.add(hash_inserts);
 }
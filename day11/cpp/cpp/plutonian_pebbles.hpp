@@ -14,8 +14,21 @@
 #include <fstream>
 #include <stdexcept>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <thread>
 #include <optional>
+#include <span>
+#include <limits>
+#include <mutex>
 
+/**
+ * @class PlutonianPebble
+ * @brief A pebble with an engraved number that changes every blink.
+ *
+ * The rules are implemented by a string-free kernel working directly on engraved numbers,
+ * which is also available for whole arrays of numbers through apply_rule_to_numbers.
+ */
 class PlutonianPebble
 {
 public:
@@ -23,37 +36,156 @@ public:
     std::optional<PlutonianPebble> apply_plutonian_pebble_rule();
     size_t engraved_number;
     friend std::ostream &operator<<(std::ostream &os, const PlutonianPebble &pebble);
-private:
-    std::pair<size_t, size_t> get_separated_numbers(size_t number_of_digits);
-    static size_t convert_to_integer(const std::string &str);
-    static size_t remove_leading_zeros(const std::string &str);
+
+    static constexpr size_t NO_SPLIT = std::numeric_limits<size_t>::max();
+    static size_t apply_rule_to_number(size_t &engraved_number);
+    static void apply_rule_to_numbers(std::span<size_t> engraved_numbers, std::span<size_t> split_off_numbers);
+    static size_t count_digits(size_t number);
 };
 
+/**
+ * @class PlutonianPebbleTransformer
+ * @brief Applies the pebble rules to a line of pebbles for a number of blinks.
+ *
+ * Counting only needs the number of pebbles per engraved number, since pebbles with the same number
+ * always evolve the same way. The ordered line is only materialized by get_pebble_order_after_blinking.
+ * Pebbles also evolve independently of each other, so get_number_of_pebbles_after_blinking_in_parallel
+ * counts the subtrees of distinct engraved numbers as separate tasks on a pool of workers.
+ */
 class PlutonianPebbleTransformer
 {
 public:
     PlutonianPebbleTransformer(const std::vector<size_t> &starting_pebble_order);
     size_t get_number_of_pebbles_after_blinking(size_t number_of_blinks);
+    size_t get_number_of_pebbles_after_blinking_in_parallel(size_t number_of_blinks, size_t number_of_threads = 0);
+    std::vector<size_t> get_pebble_order_after_blinking(size_t number_of_blinks);
 
 private:
+    /**
+     * @struct BlinkBuffers
+     * @brief Scratch buffers for blinking pebble counts, reused from one blink to the next.
+     */
+    struct BlinkBuffers
+    {
+        std::unordered_map<size_t, size_t> next_pebble_counts;
+        std::vector<size_t> engraved_numbers, split_off_numbers, counts;
+    };
+
     std::vector<PlutonianPebble> current_pebble_order;
+    std::unordered_map<size_t, size_t> count_pebbles_by_engraved_number();
+    static void blink_pebble_counts(std::unordered_map<size_t, size_t> &pebble_counts, BlinkBuffers &buffers);
     size_t number_of_blinks;
     std::vector<PlutonianPebble> convert_integers_to_pebbles(const std::vector<size_t> &pebble_order);
     void print_pebbles();
 };
 
+/**
+ * @class PebbleCountKey
+ * @brief Identifies the number of pebbles a single pebble turns into after a number of blinks.
+ */
+class PebbleCountKey
+{
+public:
+    size_t engraved_number;
+    size_t remaining_blinks;
+    bool operator==(const PebbleCountKey &other) const;
+};
+
+/**
+ * @namespace std
+ * @brief Hash specialization for PebbleCountKey for use in unordered_map.
+ */
+namespace std
+{
+    template <>
+    struct hash<PebbleCountKey>
+    {
+        std::size_t operator()(const PebbleCountKey &key) const
+        {
+            // Mix both fields so that keys with swapped or nearby values do not collide
+            std::size_t h = key.engraved_number * 0x9E3779B97F4A7C15ULL;
+            h ^= (key.remaining_blinks + 0x632BE59BD9B4E019ULL) + (h << 6) + (h >> 2);
+            return h;
+        }
+    };
+}
+
+/**
+ * @class PebbleCountCache
+ * @brief Memoizes the number of pebbles a pebble turns into, keyed by (engraved number, remaining blinks).
+ *
+ * A single instance is shared by the whole process through shared(), so queries for different
+ * numbers of blinks and from different ManagerClass instances reuse one another's results.
+ * All methods are safe to call from multiple threads. The results are split over lock stripes by the hash of their
+ * key, and a stripe is only locked to look up or insert a single result, never while counting, so workers counting
+ * different pebbles rarely wait for each other. Two workers may count the same result at once; both get the same count.
+ */
+class PebbleCountCache
+{
+public:
+    static PebbleCountCache &shared();
+    size_t get_number_of_pebbles(size_t engraved_number, size_t remaining_blinks);
+    size_t get_number_of_pebbles_in_parallel(const std::vector<std::pair<size_t, size_t>> &pebble_counts, size_t remaining_blinks, size_t number_of_threads = 0);
+    size_t size();
+    void clear();
+
+private:
+    static constexpr size_t number_of_stripes = 64;
+
+    /**
+     * @struct Stripe
+     * @brief The results whose keys hash to one stripe, on their own cache line with their own lock.
+     */
+    struct alignas(64) Stripe
+    {
+        std::mutex stripe_mutex;
+        std::unordered_map<PebbleCountKey, size_t> pebble_counts;
+    };
+
+    /**
+     * @struct CountEvents
+     * @brief The instrumentation events of one count, kept locally and added to the shared counters once per count.
+     */
+    struct CountEvents
+    {
+        size_t cache_hits = 0, splits = 0, hash_inserts = 0;
+        void add_to_counters() const;
+    };
+
+    std::array<Stripe, number_of_stripes> stripes;
+    Stripe &get_stripe(const PebbleCountKey &key);
+    size_t count_pebbles(size_t engraved_number, size_t remaining_blinks, CountEvents &events);
+};
+
 /**
  * @class ManagerClass
  * @brief Handles reading the pebble order from file and providing the pebble changing interface.
+ *
+ * The pebble order is read once and every query is answered from it, and the number of pebbles for each number of
+ * blinks is cached on first use. On a single thread, the default, a query counts the pebbles by engraved number one
+ * blink at a time, which needs no cache and is the fastest engine on the puzzle inputs. With more threads the distinct
+ * starting pebbles are counted as separate tasks against a PebbleCountCache, the process-wide one unless another is
+ * passed; that cache is never evicted.
+ * Queries are not safe to run concurrently on the same ManagerClass.
  * @param input_file_name The path to the input file.
+ * @param number_of_threads Number of threads counting the pebbles (0 = hardware concurrency), 1 by default.
+ * @param cache The pebble count cache used with more than one thread, which must outlive the ManagerClass.
  */
 class ManagerClass
 {
 public:
-    ManagerClass(const std::string &input_file_name);
+    ManagerClass(const std::string &input_file_name, size_t number_of_threads = 1, PebbleCountCache &cache = PebbleCountCache::shared());
     size_t get_number_of_pebbles(size_t number_of_blinks);
+    std::vector<size_t> get_number_of_pebbles_for_blinks(size_t min_number_of_blinks, size_t max_number_of_blinks);
+    const std::vector<std::pair<size_t, size_t>> &get_starting_pebble_counts() const { return starting_pebble_counts; }
 
 private:
     std::vector<size_t> starting_pebble_order;
+    std::vector<std::pair<size_t, size_t>> starting_pebble_counts;
+    PlutonianPebbleTransformer transformer;
+    std::unordered_map<size_t, size_t> number_of_pebbles_by_blinks;
+    size_t number_of_threads;
+    PebbleCountCache &cache;
+    std::vector<std::pair<size_t, size_t>> count_starting_pebbles() const;
     std::vector<size_t> read_input(const std::string &filename);
 };
\ No newline at end of file
@@ -4,6 +4,8 @@
  */
 #include "gtest/gtest.h"
 // #include "gmock/gmock.h"
+#include <cstdio>
+#include <fstream>
 #include <sstream>
 #include "plutonian_pebbles.hpp"
 
@@ -17,3 +19,255 @@ TEST(PlutonianPebbleTransformerTest, GetNumberOfPebbles)
     PlutonianPebbleTransformer pebble_transformer(starting_pebble_order);
     EXPECT_EQ(pebble_transformer.get_number_of_pebbles_after_blinking(25), 55312);
 }
+
+/**
+ * @test GetPebbleOrder
+ * @brief Tests the ordered line of pebbles after blinking 6 times
+ */
+TEST(PlutonianPebbleTransformerTest, GetPebbleOrder)
+{
+    std::vector<size_t> starting_pebble_order {125, 17};
+    PlutonianPebbleTransformer pebble_transformer(starting_pebble_order);
+    EXPECT_EQ(pebble_transformer.get_pebble_order_after_blinking(6),
+              std::vector<size_t>({2097446912, 14168, 4048, 2, 0, 2, 4, 40, 48, 2024, 40, 48, 80, 96, 2, 8, 6, 7, 6, 0, 3, 2}));
+}
+
+/**
+ * @test CountingMatchesOrder
+ * @brief Tests that counting by engraved number gives the same number of pebbles as the ordered line
+ */
+TEST(PlutonianPebbleTransformerTest, CountingMatchesOrder)
+{
+    std::vector<size_t> starting_pebble_order {0, 1, 10, 99, 999, 125, 17};
+    for (size_t number_of_blinks = 0; number_of_blinks < 20; ++number_of_blinks)
+    {
+        PlutonianPebbleTransformer pebble_transformer(starting_pebble_order);
+        auto number_of_pebbles = pebble_transformer.get_number_of_pebbles_after_blinking(number_of_blinks);
+        EXPECT_EQ(number_of_pebbles, pebble_transformer.get_pebble_order_after_blinking(number_of_blinks).size());
+    }
+}
+
+/**
+ * @test GetNumberOfPebblesAfterManyBlinks
+ * @brief Tests the number of pebbles after blinking 75 times
+ */
+TEST(PlutonianPebbleTransformerTest, GetNumberOfPebblesAfterManyBlinks)
+{
+    std::vector<size_t> starting_pebble_order {125, 17};
+    PlutonianPebbleTransformer pebble_transformer(starting_pebble_order);
+    EXPECT_EQ(pebble_transformer.get_number_of_pebbles_after_blinking(75), 65601038650482);
+}
+
+/**
+ * @test ParallelCountingMatchesSerial
+ * @brief Tests that counting the pebble subtrees on several threads gives the same counts as counting on one
+ */
+TEST(PlutonianPebbleTransformerTest, ParallelCountingMatchesSerial)
+{
+    std::vector<size_t> starting_pebble_order {125, 17};
+    PlutonianPebbleTransformer pebble_transformer(starting_pebble_order);
+    for (size_t number_of_threads : {1, 2, 4, 16})
+    {
+        EXPECT_EQ(pebble_transformer.get_number_of_pebbles_after_blinking_in_parallel(0, number_of_threads), 2);
+        EXPECT_EQ(pebble_transformer.get_number_of_pebbles_after_blinking_in_parallel(6, number_of_threads), 22);
+        EXPECT_EQ(pebble_transformer.get_number_of_pebbles_after_blinking_in_parallel(25, number_of_threads), 55312);
+        EXPECT_EQ(pebble_transformer.get_number_of_pebbles_after_blinking_in_parallel(75, number_of_threads), 65601038650482);
+    }
+    EXPECT_EQ(pebble_transformer.get_pebble_order_after_blinking(0), starting_pebble_order);
+}
+
+/**
+ * @test NumberOfPebblesOverflowThrows
+ * @brief Tests that counting more pebbles than fit into a size_t throws instead of wrapping around
+ */
+TEST(PlutonianPebbleTransformerTest, NumberOfPebblesOverflowThrows)
+{
+    PlutonianPebbleTransformer pebble_transformer({125, 17});
+    EXPECT_EQ(pebble_transformer.get_number_of_pebbles_after_blinking(100), pebble_transformer.get_number_of_pebbles_after_blinking_in_parallel(100, 4));
+    for (size_t number_of_blinks : {110, 200})
+    {
+        EXPECT_THROW(pebble_transformer.get_number_of_pebbles_after_blinking(number_of_blinks), std::overflow_error);
+        EXPECT_THROW(pebble_transformer.get_number_of_pebbles_after_blinking_in_parallel(number_of_blinks, 4), std::overflow_error);
+        PebbleCountCache cache;
+        EXPECT_THROW(cache.get_number_of_pebbles(125, number_of_blinks), std::overflow_error);
+        EXPECT_THROW(cache.get_number_of_pebbles_in_parallel({{125, 1}, {17, 1}}, number_of_blinks, 1), std::overflow_error);
+    }
+    PebbleCountCache cache;
+    for (size_t number_of_threads : {1, 2})
+    {
+        ManagerClass manager("../small_puzzle_input", number_of_threads, cache);
+        EXPECT_THROW(manager.get_number_of_pebbles(110), std::overflow_error);
+    }
+}
+
+/**
+ * @test CountDigits
+ * @brief Tests counting digits at the power of ten boundaries
+ */
+TEST(PlutonianPebbleTest, CountDigits)
+{
+    EXPECT_EQ(PlutonianPebble::count_digits(0), 1);
+    EXPECT_EQ(PlutonianPebble::count_digits(9), 1);
+    EXPECT_EQ(PlutonianPebble::count_digits(10), 2);
+    EXPECT_EQ(PlutonianPebble::count_digits(99), 2);
+    EXPECT_EQ(PlutonianPebble::count_digits(100), 3);
+    EXPECT_EQ(PlutonianPebble::count_digits(999999999999), 12);
+    EXPECT_EQ(PlutonianPebble::count_digits(1000000000000), 13);
+    EXPECT_EQ(PlutonianPebble::count_digits(std::numeric_limits<size_t>::max()), 20);
+}
+
+/**
+ * @test ApplyRuleToNumber
+ * @brief Tests the three pebble rules and detection of overflow
+ */
+TEST(PlutonianPebbleTest, ApplyRuleToNumber)
+{
+    size_t number = 0;
+    EXPECT_EQ(PlutonianPebble::apply_rule_to_number(number), PlutonianPebble::NO_SPLIT);
+    EXPECT_EQ(number, 1);
+
+    number = 1000;
+    EXPECT_EQ(PlutonianPebble::apply_rule_to_number(number), 10);
+    EXPECT_EQ(number, 0);
+
+    number = 125;
+    EXPECT_EQ(PlutonianPebble::apply_rule_to_number(number), PlutonianPebble::NO_SPLIT);
+    EXPECT_EQ(number, 253000);
+
+    number = std::numeric_limits<size_t>::max() / 1000;
+    EXPECT_THROW(PlutonianPebble::apply_rule_to_number(number), std::overflow_error);
+}
+
+/**
+ * @test ApplyRuleToNumbers
+ * @brief Tests that the batch kernel matches the single number kernel
+ */
+TEST(PlutonianPebbleTest, ApplyRuleToNumbers)
+{
+    std::vector<size_t> engraved_numbers {0, 1, 10, 99, 999, 2024, 253000, 1036288};
+    std::vector<size_t> split_off_numbers(engraved_numbers.size());
+    auto expected_numbers = engraved_numbers;
+    PlutonianPebble::apply_rule_to_numbers(engraved_numbers, split_off_numbers);
+    for (size_t idx = 0; idx < expected_numbers.size(); ++idx)
+    {
+        EXPECT_EQ(split_off_numbers[idx], PlutonianPebble::apply_rule_to_number(expected_numbers[idx]));
+        EXPECT_EQ(engraved_numbers[idx], expected_numbers[idx]);
+    }
+
+    std::vector<size_t> too_small(1);
+    EXPECT_THROW(PlutonianPebble::apply_rule_to_numbers(engraved_numbers, too_small), std::invalid_argument);
+
+    // A large number with an even count of digits splits, one with an odd count overflows and leaves both arrays untouched
+    std::vector<size_t> large_numbers {10000000000000000000ull, 125};
+    std::vector<size_t> large_split_off_numbers(large_numbers.size());
+    PlutonianPebble::apply_rule_to_numbers(large_numbers, large_split_off_numbers);
+    EXPECT_EQ(large_split_off_numbers[0], 1000000000);
+    std::vector<size_t> overflowing_numbers {125, 10000000000000001, 17};
+    std::vector<size_t> overflowing_split_off_numbers(overflowing_numbers.size(), 7);
+    EXPECT_THROW(PlutonianPebble::apply_rule_to_numbers(overflowing_numbers, overflowing_split_off_numbers), std::overflow_error);
+    EXPECT_EQ(overflowing_numbers, (std::vector<size_t>{125, 10000000000000001, 17}));
+    EXPECT_EQ(overflowing_split_off_numbers, std::vector<size_t>(3, 7));
+}
+
+/**
+ * @test CachedCountsMatchTransformer
+ * @brief Tests that the shared pebble count cache gives the same counts as the transformer and reuses its results
+ */
+TEST(PebbleCountCacheTest, CachedCountsMatchTransformer)
+{
+    auto &cache = PebbleCountCache::shared();
+    cache.clear();
+    std::vector<size_t> starting_pebble_order {0, 1, 10, 99, 999, 125, 17};
+    for (auto engraved_number : starting_pebble_order)
+    {
+        PlutonianPebbleTransformer pebble_transformer({engraved_number});
+        EXPECT_EQ(cache.get_number_of_pebbles(engraved_number, 30), pebble_transformer.get_number_of_pebbles_after_blinking(30));
+    }
+
+    // 125 turns into 253000 after one blink, so that result was cached on the way
+    auto cache_size = cache.size();
+    EXPECT_EQ(cache.get_number_of_pebbles(253000, 29), cache.get_number_of_pebbles(125, 30));
+    EXPECT_EQ(cache.size(), cache_size);
+}
+
+/**
+ * @test ParallelCountsMatchTransformer
+ * @brief Tests that groups of equal pebbles counted on several threads against one cache give the transformer's counts
+ */
+TEST(PebbleCountCacheTest, ParallelCountsMatchTransformer)
+{
+    std::vector<std::pair<size_t, size_t>> pebble_counts {{0, 3}, {1, 1}, {10, 2}, {99, 1}, {999, 4}, {125, 2}, {17, 1}};
+    std::vector<size_t> starting_pebble_order;
+    for (const auto &[engraved_number, occurrences] : pebble_counts)
+    {
+        starting_pebble_order.insert(starting_pebble_order.end(), occurrences, engraved_number);
+    }
+    size_t expected = PlutonianPebbleTransformer(starting_pebble_order).get_number_of_pebbles_after_blinking(40);
+    for (size_t number_of_threads : {0, 1, 4, 16})
+    {
+        PebbleCountCache cache;
+        EXPECT_EQ(cache.get_number_of_pebbles_in_parallel(pebble_counts, 40, number_of_threads), expected);
+        EXPECT_EQ(cache.get_number_of_pebbles_in_parallel(pebble_counts, 40, number_of_threads), expected);
+    }
+}
+
+/**
+ * @test GetNumberOfPebblesForBlinks
+ * @brief Tests the number of pebbles for a range of blinks
+ */
+TEST(ManagerClassTest, GetNumberOfPebblesForBlinks)
+{
+    ManagerClass manager("../small_puzzle_input");
+    auto number_of_pebbles = manager.get_number_of_pebbles_for_blinks(5, 25);
+    ASSERT_EQ(number_of_pebbles.size(), 21);
+    EXPECT_EQ(number_of_pebbles.front(), 13);
+    EXPECT_EQ(number_of_pebbles[1], 22);
+    EXPECT_EQ(number_of_pebbles.back(), 55312);
+    EXPECT_EQ(manager.get_number_of_pebbles(25), 55312);
+    EXPECT_THROW(manager.get_number_of_pebbles_for_blinks(2, 1), std::invalid_argument);
+}
+
+/**
+ * @test RepeatedStartingPebblesAreCountedOnce
+ * @brief Tests that repeated starting pebbles and repeated queries give the same counts as a transformer.
+ */
+TEST(ManagerClassTest, RepeatedStartingPebblesAreCountedOnce)
+{
+    const std::string filename = "repeated_pebbles_input";
+    std::ofstream(filename) << "125 17 125 0 17 125\n";
+    ManagerClass manager(filename);
+    std::remove(filename.c_str());
+    size_t expected = PlutonianPebbleTransformer({125, 17, 125, 0, 17, 125}).get_number_of_pebbles_after_blinking(20);
+    EXPECT_EQ(manager.get_number_of_pebbles(20), expected);
+    EXPECT_EQ(manager.get_number_of_pebbles(20), expected);
+    EXPECT_EQ(manager.get_number_of_pebbles_for_blinks(19, 20).back(), expected);
+}
+
+/**
+ * @test ParallelManagerMatchesSerial
+ * @brief Tests that counting the starting pebbles on several threads gives the answers of both parts
+ */
+TEST(ManagerClassTest, ParallelManagerMatchesSerial)
+{
+    ManagerClass manager("../small_puzzle_input", 4);
+    EXPECT_EQ(manager.get_number_of_pebbles(25), 55312);
+    EXPECT_EQ(manager.get_number_of_pebbles(75), 65601038650482);
+}
+
+/**
+ * @test OwnCacheLeavesSharedCacheUntouched
+ * @brief Tests that a single-threaded ManagerClass uses no cache and a parallel one given its own cache fills that one
+ */
+TEST(ManagerClassTest, OwnCacheLeavesSharedCacheUntouched)
+{
+    PebbleCountCache::shared().clear();
+    PebbleCountCache cache;
+    ManagerClass serial_manager("../small_puzzle_input", 1, cache);
+    EXPECT_EQ(serial_manager.get_number_of_pebbles(25), 55312);
+    EXPECT_EQ(cache.size(), 0);
+
+    ManagerClass parallel_manager("../small_puzzle_input", 2, cache);
+    EXPECT_EQ(parallel_manager.get_number_of_pebbles(25), 55312);
+    EXPECT_GT(cache.size(), 0);
+    EXPECT_EQ(PebbleCountCache::shared().size(), 0);
+}
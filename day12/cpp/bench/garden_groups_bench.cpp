@@ -0,0 +1,54 @@
+#include "bench.hpp"
+#include "garden_groups.hpp"
+
+/**
+ * @brief Generates a garden of four plant types that mostly continue the plot to their left or above, so regions grow in patches.
+ * @param size The number of rows and columns.
+ */
+std::string generate_garden(bench::Generator &generator, size_t size)
+{
+    return generator.grid(size, size, [size](bench::Generator &g, size_t r, size_t c, const std::string &garden)
+                          {
+        if (c > 0 && g.chance(0.6))
+            return garden.back();
+        if (r > 0 && g.chance(0.5))
+            return garden[garden.size() - (size + 1)];
+        return static_cast<char>('A' + g.uniform(0, 3)); });
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        bench::Suite suite("Garden Groups", argc, argv);
+        bench::Generator generator;
+        for (size_t size : {32 * suite.get_scale(), 140 * suite.get_scale()})
+        {
+            std::string label = std::to_string(size) + "x" + std::to_string(size);
+            std::string filename = bench::write_input("build/bench_garden_" + label, generate_garden(generator, size));
+
+            suite.run("parse@" + label, [&]
+                      { return ManagerClass(filename).get_fence_pricing(false); });
+            for (bool with_sides : {false, true})
+            {
+                std::string group = (with_sides ? "pricing_with_sides@" : "pricing@") + label;
+                suite.run(group + "/REGION_FLOOD_FILL", [&]
+                          { return ManagerClass(filename).get_fence_pricing(with_sides, PricingEngine::REGION_FLOOD_FILL); });
+                suite.run(group + "/REGION_LABELLING", [&]
+                          { return ManagerClass(filename).get_fence_pricing(with_sides, PricingEngine::REGION_LABELLING); });
+            }
+            suite.run("both_parts@" + label + "/MANAGER_PER_PART", [&]
+                      { return ManagerClass(filename).get_fence_pricing(false) + ManagerClass(filename).get_fence_pricing(true); });
+            suite.run("both_parts@" + label + "/SESSION", [&]
+                      {
+                          ManagerClass manager(filename);
+                          return manager.get_fence_pricing(false) + manager.get_fence_pricing(true); });
+        }
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,4 +1,10 @@
 #include "garden_groups.hpp"
+#include "instrumentation.hpp"
+
+static instrumentation::Counter regions_found("regions_found");
+static instrumentation::Counter region_unions("region_unions");
+static instrumentation::Phase compute_phase("compute");
+static instrumentation::Phase reduce_phase("reduce");
 
 /**
  * @brief Constructs a Position object.
@@ -270,20 +276,45 @@ Position RegionSide::get_end_position(std::vector<TraversePosition> search_posit
     }
 }
 
+/**
+ * @brief Constructs a VisitedPlots object with no plot visited yet.
+ * @param rows The number of rows of the garden.
+ * @param cols The number of columns of the garden.
+ * @throws std::invalid_argument if the garden has too many plots to give every region its own generation.
+ */
+VisitedPlots::VisitedPlots(size_t rows, size_t cols)
+    : stamps(rows, cols, 0), generation(0)
+{
+    if (rows * cols >= UINT32_MAX)
+        throw std::invalid_argument("Error: The garden has too many plots to be flood-filled.");
+}
+
+/**
+ * @brief Starts the flood fill of the next region, so none of the plots count as visited by it yet.
+ *
+ * A garden has fewer regions than plots, so the generation never wraps around.
+ */
+void VisitedPlots::next_region()
+{
+    ++generation;
+}
+
 /**
  * @brief Constructs a Region object.
  * @param plant The plant type for the region.
  * @param r The row index of the starting position.
  * @param c The column index of the starting position.
  * @param garden The garden grid.
+ * @param visited_plots The visited bitmap of the garden, stamped with the generation of this region while it is flood-filled.
  */
 Region::Region(char plant,
                size_t r,
                size_t c,
-               const std::vector<std::vector<char>> &garden)
-    : plant(plant), garden(garden)
+               const Grid<char> &garden,
+               VisitedPlots &visited_plots)
+    : plant(plant)
 {
-    get_region_plots(r, c, garden);
+    get_region_plots(r, c, garden, visited_plots);
 };
 
 /**
@@ -295,17 +326,29 @@ Region::Region(char plant,
 std::ostream &operator<<(std::ostream &os, const Region &r)
 {
     os << "Region plots for plant " << r.plant << ": " << std::endl;
-    for (int i = 0; i < (int)r.visited_garden_plots.size(); ++i)
+    for (const auto &plot : r.traverse_positions)
     {
-        for (int j = 0; j < (int)r.visited_garden_plots[i].size(); ++j)
-        {
-            os << r.visited_garden_plots[i][j] << " ";
-        }
-        os << std::endl;
+        os << Position(plot.x_position, plot.y_position) << " ";
     }
+    os << std::endl;
     return os;
 }
 
+/**
+ * @brief Returns the number of bytes held by the plots of the region, including the side states of every plot.
+ * @return The number of bytes.
+ */
+size_t Region::get_memory_usage() const
+{
+    size_t bytes = traverse_positions.capacity() * sizeof(TraversePosition);
+    for (const auto &plot : traverse_positions)
+    {
+        bytes += plot.side_status_map.bucket_count() * sizeof(void *) +
+                 plot.side_status_map.size() * (sizeof(std::pair<const SideOrientation, SideStatus>) + sizeof(void *));
+    }
+    return bytes;
+}
+
 /**
  * @brief Calculates the fence pricing for the region.
  * @param with_sides Whether to include sides instead of perimeter in the pricing calculation.
@@ -318,7 +361,6 @@ size_t Region::get_fence_pricing(bool with_sides)
         return 0;
     }
 
-    std::cout << "Calculating fence pricing for plant " << plant << " region = ";
     if (with_sides)
     {
         // print_region_plots();
@@ -336,7 +378,6 @@ size_t Region::get_fence_pricing(bool with_sides)
  */
 size_t Region::get_area()
 {
-    std::cout << "Area(" << traverse_positions.size() << ") * ";
     return traverse_positions.size();
 }
 
@@ -355,7 +396,6 @@ size_t Region::get_perimeter()
     {
         perimeter += position.get_number_of_perimeter_sides();
     }
-    std::cout << "Perimeter(" << perimeter << ")" << std::endl;
     return perimeter;
 }
 
@@ -398,7 +438,6 @@ size_t Region::get_num_of_region_sides()
             }
         }
     }
-    std::cout << "RegionSides(" << region_sides.size() << ")" << std::endl;
     return region_sides.size();
 }
 
@@ -408,25 +447,28 @@ size_t Region::get_num_of_region_sides()
  * @param r The row index of the starting plot.
  * @param c The column index of the starting plot.
  * @param garden A 2D vector representing the garden layout, where each cell contains a character.
+ * @param visited_plots The visited bitmap of the garden, reset for this region before the flood fill starts.
+ * @throws std::invalid_argument if the visited bitmap does not match the size of the garden.
  */
-void Region::get_region_plots(size_t r, size_t c, const std::vector<std::vector<char>> &garden)
+void Region::get_region_plots(size_t r, size_t c, const Grid<char> &garden, VisitedPlots &visited_plots)
 {
-    if (visited_garden_plots.empty() || visited_garden_plots.at(0).size() != garden[0].size())
-        visited_garden_plots.resize(garden.size(), std::vector<bool>(garden[0].size(), false));
+    if (visited_plots.get_rows() != garden.get_rows() || visited_plots.get_cols() != garden.get_cols())
+        throw std::invalid_argument("Error: The visited plots need the same size as the garden.");
 
-    if (visited_garden_plots[r][c])
+    visited_plots.next_region();
+    if (visited_plots.is_visited(r, c))
     {
-        // std::cout << garden[r][c] << ": Already visited at (" << r << ", " << c << ")." << std::endl;
+        // std::cout << garden.at(r, c) << ": Already visited at (" << r << ", " << c << ")." << std::endl;
         return; // Already visited
     }
 
-    auto result = get_traverse_position(r, c, garden);
+    auto result = get_traverse_position(r, c, garden, visited_plots);
     if (result.has_value())
     {
         auto tp = result.value();
         traverse_positions.push_back(tp);
         // std::cout << "Traversing from position (" << tp.x_position << ", " << tp.y_position << ")" << std::endl;
-        traverse_from_position(tp, garden);
+        traverse_from_position(tp, garden, visited_plots);
     }
     else
     {
@@ -441,17 +483,17 @@ void Region::get_region_plots(size_t r, size_t c, const std::vector<std::vector<
  * @param r Row index in the garden grid.
  * @param c Column index in the garden grid.
  * @param garden 2D vector representing the garden layout.
+ * @param visited_plots The visited bitmap of the garden.
  * @return std::optional<TraversePosition> The TraversePosition at (r, c) if valid, otherwise std::nullopt.
  */
-std::optional<TraversePosition> Region::get_traverse_position(int r, int c, const std::vector<std::vector<char>> &garden)
+std::optional<TraversePosition> Region::get_traverse_position(int r, int c, const Grid<char> &garden, const VisitedPlots &visited_plots)
 {
-    if (r < 0 || r >= static_cast<int>(garden.size()) || c < 0 || c >= static_cast<int>(garden[0].size()))
+    if (!garden.contains(r, c))
     {
-        std::cout << "Position (" << r << ", " << c << ") is out of garden bounds." << std::endl;
         return std::nullopt;
     }
-    TraversePosition tp(c, r, garden[r][c]);
-    update_side_status(tp, garden);
+    TraversePosition tp(c, r, garden.at(r, c));
+    update_side_status(tp, garden, visited_plots);
     // std::cout << "Created TraversePosition at (" << tp.x_position << ", " << tp.y_position << ")" << std::endl;
     return tp;
 }
@@ -466,10 +508,11 @@ std::optional<TraversePosition> Region::get_traverse_position(int r, int c, cons
  *
  * @param tp The current traverse position, including coordinates and side status map.
  * @param garden The 2D grid representing the garden layout.
+ * @param visited_plots The visited bitmap of the garden.
  */
-void Region::traverse_from_position(TraversePosition &tp, const std::vector<std::vector<char>> &garden)
+void Region::traverse_from_position(TraversePosition &tp, const Grid<char> &garden, VisitedPlots &visited_plots)
 {
-    visited_garden_plots[tp.y_position][tp.x_position] = true;
+    visited_plots.visit(tp.y_position, tp.x_position);
 
     for (auto &pair : tp.side_status_map)
     {
@@ -502,14 +545,14 @@ void Region::traverse_from_position(TraversePosition &tp, const std::vector<std:
             break;
         }
 
-        // std::cout << "Checking side in direction " << direction << " to position (" << new_c << ", " << new_r << ") containing " << garden[new_r][new_c] << std::endl;
+        // std::cout << "Checking side in direction " << direction << " to position (" << new_c << ", " << new_r << ") containing " << garden.at(new_r, new_c) << std::endl;
 
-        auto result = get_traverse_position(new_r, new_c, garden);
+        auto result = get_traverse_position(new_r, new_c, garden, visited_plots);
         tp.update_side_status(side_orientation, SideStatus::VISITED);
-        if (result.has_value() && result.value().value == plant && !visited_garden_plots[new_r][new_c])
+        if (result.has_value() && result.value().value == plant && !visited_plots.is_visited(new_r, new_c))
         {
             // std::cout << "Can visit side" << std::endl;
-            visited_garden_plots[new_r][new_c] = true;
+            visited_plots.visit(new_r, new_c);
 
             auto new_tp = result.value();
             // Update the opposite direction as VISITED
@@ -535,7 +578,7 @@ void Region::traverse_from_position(TraversePosition &tp, const std::vector<std:
             new_tp.update_side_status(opposite_direction, SideStatus::VISITED);
             traverse_positions.push_back(new_tp);
             // std::cout << "Traversing from position (" << new_tp.x_position << ", " << new_tp.y_position << ")" << std::endl;
-            traverse_from_position(new_tp, garden);
+            traverse_from_position(new_tp, garden, visited_plots);
         }
     }
 }
@@ -553,8 +596,9 @@ void Region::traverse_from_position(TraversePosition &tp, const std::vector<std:
  *
  * @param tp Reference to the TraversePosition whose side statuses will be updated.
  * @param garden 2D vector representing the garden layout, where each cell contains a plant type.
+ * @param visited_plots The visited bitmap of the garden.
  */
-void Region::update_side_status(TraversePosition &tp, const std::vector<std::vector<char>> &garden)
+void Region::update_side_status(TraversePosition &tp, const Grid<char> &garden, const VisitedPlots &visited_plots)
 {
     // std::cout << "Updating side status for position (" << tp.x_position << ", " << tp.y_position << ")" << std::endl;
 
@@ -565,36 +609,36 @@ void Region::update_side_status(TraversePosition &tp, const std::vector<std::vec
 
     if (up < 0)
         tp.update_side_status(SideOrientation::UPPER, SideStatus::OUT_OF_BOUNDS);
-    else if (garden[up][tp.x_position] != plant)
+    else if (garden.at(up, tp.x_position) != plant)
         tp.update_side_status(SideOrientation::UPPER, SideStatus::ADJACENT_TO_OTHER_PLANT_TYPE);
-    else if (visited_garden_plots[up][tp.x_position])
+    else if (visited_plots.is_visited(up, tp.x_position))
         tp.update_side_status(SideOrientation::UPPER, SideStatus::VISITED);
     else
         tp.update_side_status(SideOrientation::UPPER, SideStatus::AVAILABLE);
 
-    if (down > (int)garden.size() - 1)
+    if (down > (int)garden.get_rows() - 1)
         tp.update_side_status(SideOrientation::LOWER, SideStatus::OUT_OF_BOUNDS);
-    else if (garden[down][tp.x_position] != plant)
+    else if (garden.at(down, tp.x_position) != plant)
         tp.update_side_status(SideOrientation::LOWER, SideStatus::ADJACENT_TO_OTHER_PLANT_TYPE);
-    else if (visited_garden_plots[down][tp.x_position])
+    else if (visited_plots.is_visited(down, tp.x_position))
         tp.update_side_status(SideOrientation::LOWER, SideStatus::VISITED);
     else
         tp.update_side_status(SideOrientation::LOWER, SideStatus::AVAILABLE);
 
     if (left < 0)
         tp.update_side_status(SideOrientation::LEFT, SideStatus::OUT_OF_BOUNDS);
-    else if (garden[tp.y_position][left] != plant)
+    else if (garden.at(tp.y_position, left) != plant)
         tp.update_side_status(SideOrientation::LEFT, SideStatus::ADJACENT_TO_OTHER_PLANT_TYPE);
-    else if (visited_garden_plots[tp.y_position][left])
+    else if (visited_plots.is_visited(tp.y_position, left))
         tp.update_side_status(SideOrientation::LEFT, SideStatus::VISITED);
     else
         tp.update_side_status(SideOrientation::LEFT, SideStatus::AVAILABLE);
 
-    if (right > (int)garden[0].size() - 1)
+    if (right > (int)garden.get_cols() - 1)
         tp.update_side_status(SideOrientation::RIGHT, SideStatus::OUT_OF_BOUNDS);
-    else if (garden[tp.y_position][right] != plant)
+    else if (garden.at(tp.y_position, right) != plant)
         tp.update_side_status(SideOrientation::RIGHT, SideStatus::ADJACENT_TO_OTHER_PLANT_TYPE);
-    else if (visited_garden_plots[tp.y_position][right])
+    else if (visited_plots.is_visited(tp.y_position, right))
         tp.update_side_status(SideOrientation::RIGHT, SideStatus::VISITED);
     else
         tp.update_side_status(SideOrientation::RIGHT, SideStatus::AVAILABLE);
@@ -631,14 +675,279 @@ size_t GardenGroup::get_fence_pricing(bool with_sides)
  */
 void GardenGroup::add_region(Region region)
 {
-    regions.emplace_back(region);
+    regions.emplace_back(std::move(region));
 }
 
 /**
- * @brief Constructs a Gardener object and initializes garden groups.
- * @param garden A 2D vector representing the garden layout.
+ * @brief Returns the number of bytes held by the regions of the garden group.
+ * @return The number of bytes.
  */
-Gardener::Gardener(std::vector<std::vector<char>> garden) : garden_groups(find_garden_groups(garden)) {};
+size_t GardenGroup::get_memory_usage() const
+{
+    size_t bytes = regions.capacity() * sizeof(Region);
+    for (const auto &region : regions)
+    {
+        bytes += region.get_memory_usage();
+    }
+    return bytes;
+}
+
+/**
+ * @brief Constructs a RegionLabelling object and labels all regions of the garden.
+ *
+ * With more than one thread the garden is split into horizontal bands that are labelled independently, each on its own thread.
+ * The fences and corners of a plot are read from the whole garden, so they are already correct along the seams between
+ * the bands. Only the regions crossing a seam are left to be merged, which is done once all bands are labelled.
+ * @param garden The garden grid.
+ * @param number_of_threads Number of bands labelled in parallel (0 = hardware concurrency).
+ * @throws std::invalid_argument if the garden has too many plots for 32 bit labels.
+ */
+RegionLabelling::RegionLabelling(const Grid<char> &garden, size_t number_of_threads)
+{
+    size_t plots = garden.get_rows() * garden.get_cols();
+    if (plots > UINT32_MAX)
+        throw std::invalid_argument("Error: The garden has too many plots to be labelled.");
+
+    parent.resize(plots);
+    measures.resize(plots);
+    if (number_of_threads == 0)
+        number_of_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::optional<instrumentation::ScopedTimer> compute_timer(compute_phase);
+    size_t bands = std::min(number_of_threads, garden.get_rows());
+    if (bands <= 1)
+    {
+        size_t unions = label_band(garden, 0, garden.get_rows());
+        region_unions.add(unions);
+        regions_found.add(plots - unions);
+        return;
+    }
+
+    std::vector<size_t> band_starts;
+    for (size_t band = 0; band <= bands; ++band)
+    {
+        band_starts.push_back(band * garden.get_rows() / bands);
+    }
+    std::vector<size_t> unions_per_band(bands);
+    std::vector<std::thread> threads;
+    threads.reserve(bands);
+    for (size_t band = 0; band < bands; ++band)
+    {
+        threads.emplace_back([&, band]()
+                             { unions_per_band[band] = label_band(garden, band_starts[band], band_starts[band + 1]); });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    compute_timer.reset();
+
+    instrumentation::ScopedTimer reduce_timer(reduce_phase);
+    size_t unions = unions_per_band[0];
+    for (size_t band = 1; band < bands; ++band)
+    {
+        unions += unions_per_band[band] + merge_seam(garden, band_starts[band]);
+    }
+    region_unions.add(unions);
+    regions_found.add(plots - unions);
+}
+
+/**
+ * @brief Labels the plots of a horizontal band of rows, merging plots only with neighbours inside the band.
+ *
+ * Bands only touch the labels of their own plots, so different bands can be labelled at the same time.
+ * @param garden The garden grid.
+ * @param first_row The first row of the band.
+ * @param end_row The row after the last row of the band.
+ * @return The number of times two regions were merged.
+ */
+size_t RegionLabelling::label_band(const Grid<char> &garden, size_t first_row, size_t end_row)
+{
+    size_t unions = 0;
+    uint32_t cols = garden.get_cols();
+    for (int r = first_row; r < (int)end_row; ++r)
+    {
+        for (int c = 0; c < (int)garden.get_cols(); ++c)
+        {
+            uint32_t label = r * cols + c;
+            parent[label] = label;
+            measures[label] = {1, count_fences(garden, r, c), count_corners(garden, r, c)};
+
+            char plant = garden.at(r, c);
+            if (r > (int)first_row && garden.at(r - 1, c) == plant)
+                unions += unite(label, label - cols);
+            if (c > 0 && garden.at(r, c - 1) == plant)
+                unions += unite(label, label - 1);
+        }
+    }
+    return unions;
+}
+
+/**
+ * @brief Merges the regions crossing the seam above a row with the regions on the other side of the seam.
+ * @param garden The garden grid.
+ * @param row The first row below the seam.
+ * @return The number of times two regions were merged.
+ */
+size_t RegionLabelling::merge_seam(const Grid<char> &garden, size_t row)
+{
+    size_t unions = 0;
+    uint32_t cols = garden.get_cols();
+    for (int c = 0; c < (int)garden.get_cols(); ++c)
+    {
+        if (garden.at(row, c) == garden.at(row - 1, c))
+            unions += unite(row * cols + c, (row - 1) * cols + c);
+    }
+    return unions;
+}
+
+/**
+ * @brief Returns the number of fences around a plot, the sides facing another plant type or the edge of the garden.
+ * @param garden The garden grid.
+ * @param r The row index of the plot.
+ * @param c The column index of the plot.
+ * @return The number of fences.
+ */
+uint32_t RegionLabelling::count_fences(const Grid<char> &garden, int r, int c)
+{
+    char plant = garden.at(r, c);
+    uint32_t fences = 0;
+    for (auto [dr, dc] : {std::pair{-1, 0}, std::pair{1, 0}, std::pair{0, -1}, std::pair{0, 1}})
+    {
+        if (!garden.contains(r + dr, c + dc) || garden.at(r + dr, c + dc) != plant)
+            fences++;
+    }
+    return fences;
+}
+
+/**
+ * @brief Returns the number of region corners at a plot, one for every diagonal of the plot that bends the fence.
+ *
+ * Towards each diagonal the fence has an outer corner if both plots next to the diagonal hold other plants,
+ * and an inner corner if both hold the same plant but the diagonal plot does not.
+ * @param garden The garden grid.
+ * @param r The row index of the plot.
+ * @param c The column index of the plot.
+ * @return The number of corners.
+ */
+uint32_t RegionLabelling::count_corners(const Grid<char> &garden, int r, int c)
+{
+    char plant = garden.at(r, c);
+    auto same_plant = [&](int row, int col)
+    { return garden.contains(row, col) && garden.at(row, col) == plant; };
+
+    uint32_t corners = 0;
+    for (auto [dr, dc] : {std::pair{-1, -1}, std::pair{-1, 1}, std::pair{1, -1}, std::pair{1, 1}})
+    {
+        bool vertical = same_plant(r + dr, c);
+        bool horizontal = same_plant(r, c + dc);
+        if ((!vertical && !horizontal) || (vertical && horizontal && !same_plant(r + dr, c + dc)))
+            corners++;
+    }
+    return corners;
+}
+
+/**
+ * @brief Returns the root label of the region a label belongs to, halving the path on the way.
+ * @param label The label of a plot.
+ * @return The root label.
+ */
+uint32_t RegionLabelling::find(uint32_t label)
+{
+    while (parent[label] != label)
+    {
+        parent[label] = parent[parent[label]];
+        label = parent[label];
+    }
+    return label;
+}
+
+/**
+ * @brief Merges the regions of two labels, attaching the smaller region to the larger one and adding up their measures.
+ * @param label The label of a plot.
+ * @param other_label The label of a neighbouring plot with the same plant.
+ * @return True if the labels belonged to different regions.
+ */
+bool RegionLabelling::unite(uint32_t label, uint32_t other_label)
+{
+    uint32_t root = find(label);
+    uint32_t other_root = find(other_label);
+    if (root == other_root)
+        return false;
+
+    if (measures[root].area < measures[other_root].area)
+        std::swap(root, other_root);
+    parent[other_root] = root;
+    measures[root].area += measures[other_root].area;
+    measures[root].perimeter += measures[other_root].perimeter;
+    measures[root].sides += measures[other_root].sides;
+    return true;
+}
+
+/**
+ * @brief Calculates the total fence pricing of all regions, the area of each region multiplied by its perimeter or number of sides.
+ * @param with_sides If true, bases fence pricing on number of sides of the fence; otherwise, number of perimeters.
+ * @return The total fence pricing.
+ */
+size_t RegionLabelling::get_fence_pricing(bool with_sides) const
+{
+    size_t sum = 0;
+    for (uint32_t label = 0; label < parent.size(); ++label)
+    {
+        if (parent[label] == label)
+            sum += (size_t)measures[label].area * (with_sides ? measures[label].sides : measures[label].perimeter);
+    }
+    return sum;
+}
+
+/**
+ * @brief Returns the number of bytes held by the labels and measures of the plots.
+ * @return The number of bytes.
+ */
+size_t RegionLabelling::get_memory_usage() const
+{
+    return parent.capacity() * sizeof(uint32_t) + measures.capacity() * sizeof(RegionMeasures);
+}
+
+/**
+ * @brief Returns the number of regions in the garden.
+ * @return The number of regions.
+ */
+size_t RegionLabelling::get_number_of_regions() const
+{
+    size_t regions = 0;
+    for (uint32_t label = 0; label < parent.size(); ++label)
+    {
+        if (parent[label] == label)
+            regions++;
+    }
+    return regions;
+}
+
+/**
+ * @brief Returns the number of bytes held by the garden, the visited bitmap and the regions found by either engine.
+ * @return The memory stats of the gardener.
+ */
+GardenerMemoryStats Gardener::get_memory_stats() const
+{
+    GardenerMemoryStats stats{garden.size() * sizeof(char), visited_plots.get_memory_usage(), 0, 0};
+    stats.garden_groups = garden_groups.bucket_count() * sizeof(void *);
+    for (const auto &garden_group : garden_groups)
+    {
+        stats.garden_groups += sizeof(garden_group) + sizeof(void *) + garden_group.second.get_memory_usage();
+    }
+    if (region_labelling)
+        stats.region_labelling = region_labelling->get_memory_usage();
+    return stats;
+}
+
+/**
+ * @brief Constructs a Gardener object for the garden.
+ * @param garden A grid representing the garden layout.
+ * @param number_of_threads Number of bands the REGION_LABELLING engine labels in parallel (0 = hardware concurrency).
+ */
+Gardener::Gardener(Grid<char> garden, size_t number_of_threads)
+    : garden(std::move(garden)), number_of_threads(number_of_threads) {};
 
 /**
  * @brief Calculates the total fence pricing for all garden groups.
@@ -646,10 +955,22 @@ Gardener::Gardener(std::vector<std::vector<char>> garden) : garden_groups(find_g
  * Iterates through each garden group and sums up the fence pricing.
  *
  * @param with_sides If true, bases fence pricing on number of sides of the fence; otherwise, number of perimeters.
+ * @param pricing_engine The algorithm used for finding and measuring the regions.
  * @return The total fence pricing for all garden groups.
  */
-size_t Gardener::get_fence_pricing(bool with_sides)
+size_t Gardener::get_fence_pricing(bool with_sides, PricingEngine pricing_engine)
 {
+    if (pricing_engine == PricingEngine::REGION_LABELLING)
+    {
+        if (!region_labelling)
+            region_labelling.emplace(garden, number_of_threads);
+        return region_labelling->get_fence_pricing(with_sides);
+    }
+
+    instrumentation::ScopedTimer compute_timer(compute_phase);
+    if (garden_groups.empty())
+        garden_groups = find_garden_groups(garden);
+
     size_t sum = 0;
     for (auto &garden_group : garden_groups)
     {
@@ -667,25 +988,23 @@ size_t Gardener::get_fence_pricing(bool with_sides)
  * @param garden A 2D vector representing the garden layout, where each cell contains a character representing a plant type.
  * @return An unordered map where keys are plant types (characters) and values are GardenGroup objects containing regions of that plant type.
  */
-std::unordered_map<char, GardenGroup> Gardener::find_garden_groups(const std::vector<std::vector<char>> &garden)
+std::unordered_map<char, GardenGroup> Gardener::find_garden_groups(const Grid<char> &garden)
 {
-
-    if (visited_garden_plots.empty() || visited_garden_plots.at(0).size() != garden[0].size())
-        visited_garden_plots.resize(garden.size(), std::vector<bool>(garden[0].size(), false));
+    if (visited_plots.get_rows() != garden.get_rows() || visited_plots.get_cols() != garden.get_cols())
+        visited_plots = VisitedPlots(garden.get_rows(), garden.get_cols());
 
     std::unordered_map<char, GardenGroup> groups;
     groups.reserve(26); // Reserve space for 26 letters (a-z)
 
-    for (int r = 0; r < (int)garden.size(); ++r)
+    for (int r = 0; r < (int)garden.get_rows(); ++r)
     {
-        for (int c = 0; c < (int)garden[r].size(); ++c)
+        for (int c = 0; c < (int)garden.get_cols(); ++c)
         {
-            if (visited_garden_plots[r][c])
+            if (visited_plots.is_claimed(r, c))
                 continue;
 
-            // std::cout << "Visiting garden plot (" << r << ", " << c << ") with plant type: " << garden[r][c] << std::endl;
-            visited_garden_plots[r][c] = true; // Mark the plot as visited
-            char plant_type = garden[r][c];
+            // std::cout << "Visiting garden plot (" << r << ", " << c << ") with plant type: " << garden.at(r, c) << std::endl;
+            char plant_type = garden.at(r, c);
             if (!groups.contains(plant_type))
             {
                 groups.insert(std::make_pair(plant_type, GardenGroup(plant_type)));
@@ -693,14 +1012,8 @@ std::unordered_map<char, GardenGroup> Gardener::find_garden_groups(const std::ve
             auto it = groups.find(plant_type);
             if (it != groups.end())
             {
-                Region plant_region = get_plant_region(r, c, garden);
-
-                // Mark all plots in the region as visited
-                for (auto &plot : plant_region.traverse_positions)
-                {
-                    visited_garden_plots[plot.y_position][plot.x_position] = true;
-                }
-                it->second.add_region(plant_region);
+                // The region claims all of its plots in the visited bitmap
+                it->second.add_region(get_plant_region(r, c, garden));
             }
         }
     }
@@ -715,7 +1028,9 @@ std::unordered_map<char, GardenGroup> Gardener::find_garden_groups(const std::ve
  * @param garden A 2D vector representing the garden layout.
  * @return A Region object representing the connected region of the same plant type starting from (r, c).
  */
-Region Gardener::get_plant_region(size_t r, size_t c, const std::vector<std::vector<char>> &garden)
+Region Gardener::get_plant_region(size_t r, size_t c, const Grid<char> &garden)
 {
-    return Region(garden[r][c], r, c, garden);
+    Region region(garden.at(r, c), r, c, garden, visited_plots);
+    regions_found.add();
+    return region;
 }
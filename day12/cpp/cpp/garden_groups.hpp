@@ -15,6 +15,10 @@
 #include <stdexcept>
 #include <algorithm>
 #include <optional>
+#include <cstdint>
+#include <thread>
+
+#include "grid.hpp"
 
 /**
  * @class Position
@@ -57,6 +61,19 @@ enum SideOrientation
     RIGHT,
 };
 
+/**
+ * @enum PricingEngine
+ * @brief Selects the algorithm used to find the regions of the garden and price their fences.
+ *
+ * REGION_FLOOD_FILL flood-fills every region and keeps the state of every side of every plot.
+ * REGION_LABELLING labels all regions in one raster pass with a union-find and only keeps the measures of each region.
+ */
+enum PricingEngine
+{
+    REGION_FLOOD_FILL,
+    REGION_LABELLING
+};
+
 /**
  * @class TraversePosition
  * @brief Represents a position used during traversal of the garden grid.
@@ -110,7 +127,7 @@ namespace std
     {
         std::size_t operator()(const Position &p) const
         {
-            return std::hash<int>()(p.x_position) ^ std::hash<int>()(p.y_position);
+            return std::hash<uint64_t>()(pack_position(p.x_position, p.y_position));
         }
     };
 
@@ -124,32 +141,59 @@ namespace std
     };
 }
 
+/**
+ * @class VisitedPlots
+ * @brief Visited bitmap of the garden shared by all regions of a flood fill.
+ *
+ * Every plot is stamped with the generation of the region that visited it, so starting the next region resets the
+ * bitmap without clearing it, and plots claimed by an earlier region can still be told apart from unvisited plots.
+ * @param rows The number of rows of the garden.
+ * @param cols The number of columns of the garden.
+ */
+class VisitedPlots
+{
+public:
+    VisitedPlots() : generation(0) {}
+    VisitedPlots(size_t rows, size_t cols);
+    void next_region();
+    bool is_visited(int r, int c) const { return stamps.at(r, c) == generation; }
+    bool is_claimed(int r, int c) const { return stamps.at(r, c) != 0; }
+    void visit(int r, int c) { stamps.at(r, c) = generation; }
+    size_t get_rows() const { return stamps.get_rows(); }
+    size_t get_cols() const { return stamps.get_cols(); }
+    size_t get_memory_usage() const { return stamps.size() * sizeof(uint32_t); }
+
+private:
+    Grid<uint32_t> stamps;
+    uint32_t generation;
+};
+
 /**
  * @class Region
  * @brief Represents a contiguous (horizontal/vertical) region in the garden grid.
  *
  * Stores the plant type, positions, and sides that define the region.
+ * The region is flood-filled on construction with a visited bitmap borrowed from the caller.
  */
 class Region
 {
 public:
-    Region(char plant, size_t r, size_t c, const std::vector<std::vector<char>> &garden);
+    Region(char plant, size_t r, size_t c, const Grid<char> &garden, VisitedPlots &visited_plots);
     size_t get_fence_pricing(bool with_sides);
     char plant;
     std::vector<TraversePosition> traverse_positions;
     bool operator==(const Region &other) const;
+    size_t get_memory_usage() const;
     friend std::ostream &operator<<(std::ostream &os, const Region &r);
 
 private:
-    std::vector<std::vector<bool>> visited_garden_plots;
-    const std::vector<std::vector<char>> &garden;
-    void get_region_plots(size_t r, size_t c, const std::vector<std::vector<char>> &garden);
+    void get_region_plots(size_t r, size_t c, const Grid<char> &garden, VisitedPlots &visited_plots);
     size_t get_area();
     size_t get_perimeter();
     size_t get_num_of_region_sides();
-    std::optional<TraversePosition> get_traverse_position(int r, int c, const std::vector<std::vector<char>> &garden);
-    void traverse_from_position(TraversePosition &tp, const std::vector<std::vector<char>> &garden);
-    void update_side_status(TraversePosition &tp, const std::vector<std::vector<char>> &garden);
+    std::optional<TraversePosition> get_traverse_position(int r, int c, const Grid<char> &garden, const VisitedPlots &visited_plots);
+    void traverse_from_position(TraversePosition &tp, const Grid<char> &garden, VisitedPlots &visited_plots);
+    void update_side_status(TraversePosition &tp, const Grid<char> &garden, const VisitedPlots &visited_plots);
 };
 
 /**
@@ -165,6 +209,7 @@ public:
     char plant;
     size_t get_fence_pricing(bool with_sides);
     void add_region(Region region);
+    size_t get_memory_usage() const;
     bool operator==(const GardenGroup &other) const;
 
 private:
@@ -202,38 +247,100 @@ namespace std
     };
 }
 
+/**
+ * @struct RegionMeasures
+ * @brief The measures of a region needed to price its fence.
+ */
+struct RegionMeasures
+{
+    uint32_t area, perimeter, sides;
+};
+
+/**
+ * @class RegionLabelling
+ * @brief Labels the regions of the garden with a union-find in a single raster pass.
+ *
+ * Every plot starts as its own region and is merged with the plots above and to the left of it if they hold the same plant.
+ * The measures of a region are added up when regions are merged, so once the pass is done every root label holds the
+ * measures of its whole region. Only a parent label and the measures are stored per plot.
+ * The number of sides of a region equals its number of corners, which are counted from the 2x2 neighbourhoods of each plot.
+ * Large gardens can be labelled in horizontal bands on several threads, merging the regions along the seams afterwards.
+ * @param garden The garden grid.
+ * @param number_of_threads Number of bands labelled in parallel (0 = hardware concurrency).
+ */
+class RegionLabelling
+{
+public:
+    RegionLabelling(const Grid<char> &garden, size_t number_of_threads = 1);
+    size_t get_fence_pricing(bool with_sides) const;
+    size_t get_number_of_regions() const;
+    size_t get_memory_usage() const;
+
+private:
+    std::vector<uint32_t> parent;
+    std::vector<RegionMeasures> measures;
+    size_t label_band(const Grid<char> &garden, size_t first_row, size_t end_row);
+    size_t merge_seam(const Grid<char> &garden, size_t row);
+    uint32_t find(uint32_t label);
+    bool unite(uint32_t label, uint32_t other_label);
+    static uint32_t count_fences(const Grid<char> &garden, int r, int c);
+    static uint32_t count_corners(const Grid<char> &garden, int r, int c);
+};
+
+/**
+ * @struct GardenerMemoryStats
+ * @brief The number of bytes held by the parts of a Gardener, counting the storage of its containers.
+ */
+struct GardenerMemoryStats
+{
+    size_t garden, visited_plots, garden_groups, region_labelling;
+    size_t get_total() const { return garden + visited_plots + garden_groups + region_labelling; }
+};
+
 /**
  * @class Gardener
  * @brief Responsible for analyzing the garden grid and finding groups of plants.
  *
  * Provides methods to identify and process contiguous groups of plants in the garden.
+ * The regions are only searched once a fence pricing is requested, with the engine it is requested with.
+ * @param garden The garden grid.
+ * @param number_of_threads Number of bands the REGION_LABELLING engine labels in parallel (0 = hardware concurrency).
  */
 class Gardener
 {
 public:
-    Gardener(std::vector<std::vector<char>> garden);
-    size_t get_fence_pricing(bool with_sides);
+    Gardener(Grid<char> garden, size_t number_of_threads = 1);
+    size_t get_fence_pricing(bool with_sides, PricingEngine pricing_engine = PricingEngine::REGION_LABELLING);
+    GardenerMemoryStats get_memory_stats() const;
 
 private:
-    std::vector<std::vector<bool>> visited_garden_plots;
+    Grid<char> garden;
+    size_t number_of_threads;
+    VisitedPlots visited_plots;
+    std::optional<RegionLabelling> region_labelling;
     std::unordered_map<char, GardenGroup> garden_groups;
-    std::unordered_map<char, GardenGroup> find_garden_groups(const std::vector<std::vector<char>> &garden);
-    Region get_plant_region(size_t r, size_t c, const std::vector<std::vector<char>> &garden);
+    std::unordered_map<char, GardenGroup> find_garden_groups(const Grid<char> &garden);
+    Region get_plant_region(size_t r, size_t c, const Grid<char> &garden);
 };
 
 /**
  * @class ManagerClass
  * @brief Handles reading the garden from file and providing the fence pricing interface.
+ *
+ * The garden is read once and every query is answered from it. The region labels and the flood filled regions are
+ * found on the first query of their engine and kept by the gardener, so both parts and repeated queries share them.
+ * Queries are not safe to run concurrently on the same ManagerClass.
  * @param input_file_name The path to the input file.
+ * @param number_of_threads Number of bands the REGION_LABELLING engine labels in parallel (0 = hardware concurrency).
  */
 class ManagerClass
 {
 public:
-    ManagerClass(const std::string &input_file_name);
-    size_t get_fence_pricing(bool with_sides);
+    ManagerClass(const std::string &input_file_name, size_t number_of_threads = 1);
+    size_t get_fence_pricing(bool with_sides, PricingEngine pricing_engine = PricingEngine::REGION_LABELLING);
+    GardenerMemoryStats get_memory_stats() const;
 
 private:
-    std::vector<std::vector<char>> garden;
     Gardener gardener;
-    std::vector<std::vector<char>> read_input(const std::string &filename);
+    Grid<char> read_input(const std::string &filename);
 };
\ No newline at end of file
@@ -3,49 +3,50 @@
  * @brief Implements the ManagerClass for reading hiking map input and delegating scoring and rating logic.
  */
 #include "garden_groups.hpp"
+#include "grid_file.hpp"
+#include "instrumentation.hpp"
+
+static instrumentation::Phase parse_phase("parse");
 
 /**
  * @brief Constructs a ManagerClass and reads the hiking map from file.
  * @param input_file_name The path to the input file.
+ * @param number_of_threads Number of bands the REGION_LABELLING engine labels in parallel (0 = hardware concurrency).
  */
-ManagerClass::ManagerClass(const std::string &input_file_name)
-    : garden(read_input(input_file_name)), gardener(Gardener(garden)){};
+ManagerClass::ManagerClass(const std::string &input_file_name, size_t number_of_threads)
+    : gardener(read_input(input_file_name), number_of_threads){};
 
 /**
- * @brief Reads the hiking map from the input file.
+ * @brief Reads the garden from the input file.
  *
- * Reads all non-whitespace characters from the file and returns them as a 2D vector of size_t integers.
+ * Maps the file into memory and copies its lines into a grid of plant types.
  * @param filename The path to the input file.
- * @return A 2D vector of size_t integers representing the hiking map.
+ * @return A grid of characters representing the garden.
  * @throws std::runtime_error if the file does not exist or is empty.
+ * @throws std::invalid_argument if the lines of the file differ in length.
  */
-std::vector<std::vector<char>> ManagerClass::read_input(const std::string &filename)
+Grid<char> ManagerClass::read_input(const std::string &filename)
 {
-    std::vector<std::vector<char>> garden;
-    std::ifstream infile(filename);
-    if (!infile)
-        throw std::runtime_error("Error: The file " + filename + " does not exist.");
-
-    std::string line;
-    while (std::getline(infile, line))
-    {
-        if (!line.empty())
-        {
-            garden.emplace_back(line.begin(), line.end());
-        }
-    }
-    if (garden.empty())
-    {
-        throw std::runtime_error("Error: The file " + filename + " is empty or invalid.");
-    }
-    return garden;
+    instrumentation::ScopedTimer parse_timer(parse_phase);
+    return GridFile(filename).to_grid();
 }
 
 /**
  * @brief Returns the fence pricing calculated by the gardener.
+ * @param with_sides If true, bases fence pricing on number of sides of the fence; otherwise, number of perimeters.
+ * @param pricing_engine The algorithm used for finding and measuring the regions.
  * @return The fence pricing as a size_t integer.
  */
-size_t ManagerClass::get_fence_pricing(bool with_sides)
+size_t ManagerClass::get_fence_pricing(bool with_sides, PricingEngine pricing_engine)
+{
+    return gardener.get_fence_pricing(with_sides, pricing_engine);
+}
+
+/**
+ * @brief Returns the number of bytes held by the gardener.
+ * @return The memory stats of the gardener.
+ */
+GardenerMemoryStats ManagerClass::get_memory_stats() const
 {
-    return gardener.get_fence_pricing(with_sides);
+    return gardener.get_memory_stats();
 }
@@ -5,6 +5,7 @@
 #include "gtest/gtest.h"
 // #include "gmock/gmock.h"
 #include <sstream>
+#include <random>
 #include "garden_groups.hpp"
 
 /**
@@ -17,7 +18,7 @@ TEST(GardenGroupsTest, GetAFencePricing)
                                           {'B', 'B', 'C', 'D'},
                                           {'B', 'B', 'C', 'C'},
                                           {'E', 'E', 'E', 'C'}};
-    Gardener gardener(garden);
+    Gardener gardener(Grid<char>{garden});
     EXPECT_EQ(gardener.get_fence_pricing(false), 140);
 }
 
@@ -32,7 +33,7 @@ TEST(GardenGroupsTest, GetXFencePricing)
                                           {'O', 'O', 'O', 'O', 'O'},
                                           {'O', 'X', 'O', 'X', 'O'},
                                           {'O', 'O', 'O', 'O', 'O'}};
-    Gardener gardener(garden);
+    Gardener gardener(Grid<char>{garden});
     EXPECT_EQ(gardener.get_fence_pricing(false), 772);
 }
 
@@ -52,7 +53,7 @@ TEST(GardenGroupsTest, GetRFencePricing)
                                           {'M', 'I', 'I', 'I', 'I', 'I', 'J', 'J', 'E', 'E'},
                                           {'M', 'I', 'I', 'I', 'S', 'I', 'J', 'E', 'E', 'E'},
                                           {'M', 'M', 'M', 'I', 'S', 'S', 'J', 'E', 'E', 'E'}};
-    Gardener gardener(garden);
+    Gardener gardener(Grid<char>{garden});
     EXPECT_EQ(gardener.get_fence_pricing(false), 1930);
 }
 
@@ -66,7 +67,7 @@ TEST(GardenGroupsTest, GetAFencePricingWithSides)
                                           {'B', 'B', 'C', 'D'},
                                           {'B', 'B', 'C', 'C'},
                                           {'E', 'E', 'E', 'C'}};
-    Gardener gardener(garden);
+    Gardener gardener(Grid<char>{garden});
     EXPECT_EQ(gardener.get_fence_pricing(true), 80);
 }
 
@@ -81,7 +82,7 @@ TEST(GardenGroupsTest, GetEFencePricingWithSides)
                                           {'E', 'E', 'E', 'E', 'E'},
                                           {'E', 'X', 'X', 'X', 'X'},
                                           {'E', 'E', 'E', 'E', 'E'}};
-    Gardener gardener(garden);
+    Gardener gardener(Grid<char>{garden});
     EXPECT_EQ(gardener.get_fence_pricing(true), 236);
 }
 /*
@@ -109,7 +110,7 @@ TEST(GardenGroupsTest, GetABFencePricingWithSides)
                                           {'A', 'B', 'B', 'A', 'A', 'A'},
                                           {'A', 'B', 'B', 'A', 'A', 'A'},
                                           {'A', 'A', 'A', 'A', 'A', 'A'}};
-    Gardener gardener(garden);
+    Gardener gardener(Grid<char>{garden});
     EXPECT_EQ(gardener.get_fence_pricing(true), 368);
 }
 
@@ -124,7 +125,7 @@ TEST(GardenGroupsTest, GetXFencePricingWithSides)
                                           {'O', 'O', 'O', 'O', 'O'},
                                           {'O', 'X', 'O', 'X', 'O'},
                                           {'O', 'O', 'O', 'O', 'O'}};
-    Gardener gardener(garden);
+    Gardener gardener(Grid<char>{garden});
     EXPECT_EQ(gardener.get_fence_pricing(true), 436);
 }
 
@@ -144,6 +145,122 @@ TEST(GardenGroupsTest, GetRFencePricingWithSides)
                                           {'M', 'I', 'I', 'I', 'I', 'I', 'J', 'J', 'E', 'E'},
                                           {'M', 'I', 'I', 'I', 'S', 'I', 'J', 'E', 'E', 'E'},
                                           {'M', 'M', 'M', 'I', 'S', 'S', 'J', 'E', 'E', 'E'}};
-    Gardener gardener(garden);
+    Gardener gardener(Grid<char>{garden});
     EXPECT_EQ(gardener.get_fence_pricing(true), 1206);
 }
+
+/**
+ * @brief Generates a random garden of three plant types, so regions of all shapes appear.
+ * @param rows The number of rows.
+ * @param cols The number of columns.
+ * @param seed The seed of the random number generator.
+ * @return The garden as a grid.
+ */
+static Grid<char> random_garden(size_t rows, size_t cols, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> plant(0, 2);
+    Grid<char> garden(rows, cols);
+    garden.for_each_index([&](size_t index)
+                          { garden[index] = 'A' + plant(generator); });
+    return garden;
+}
+
+/**
+ * @test RegionLabellingMatchesFloodFill
+ * @brief Tests that labelling the regions gives the same fence pricing as flood-filling them, with and without sides.
+ */
+TEST(GardenGroupsTest, RegionLabellingMatchesFloodFill)
+{
+    std::vector<std::vector<char>> garden{{'O', 'O', 'O', 'O', 'O'},
+                                          {'O', 'X', 'O', 'X', 'O'},
+                                          {'O', 'O', 'O', 'O', 'O'},
+                                          {'O', 'X', 'O', 'X', 'O'},
+                                          {'O', 'O', 'O', 'O', 'O'}};
+    RegionLabelling region_labelling(Grid<char>{garden});
+    EXPECT_EQ(region_labelling.get_number_of_regions(), 5);
+    EXPECT_EQ(region_labelling.get_fence_pricing(false), 772);
+    EXPECT_EQ(region_labelling.get_fence_pricing(true), 436);
+
+    for (unsigned seed = 0; seed < 5; ++seed)
+    {
+        Gardener gardener(random_garden(30, 41, seed));
+        EXPECT_EQ(gardener.get_fence_pricing(false, PricingEngine::REGION_LABELLING),
+                  gardener.get_fence_pricing(false, PricingEngine::REGION_FLOOD_FILL))
+            << "seed " << seed;
+        EXPECT_EQ(gardener.get_fence_pricing(true, PricingEngine::REGION_LABELLING),
+                  gardener.get_fence_pricing(true, PricingEngine::REGION_FLOOD_FILL))
+            << "seed " << seed;
+    }
+}
+
+/**
+ * @test TiledRegionLabellingMatchesSerial
+ * @brief Tests that labelling the garden in bands on several threads gives the same fence pricing as labelling it serially.
+ */
+TEST(GardenGroupsTest, TiledRegionLabellingMatchesSerial)
+{
+    for (unsigned seed = 0; seed < 3; ++seed)
+    {
+        auto garden = random_garden(97, 64, seed);
+        RegionLabelling serial(garden);
+        for (size_t number_of_threads : {2, 5, 16, 200})
+        {
+            RegionLabelling tiled(garden, number_of_threads);
+            EXPECT_EQ(tiled.get_number_of_regions(), serial.get_number_of_regions()) << number_of_threads << " threads";
+            EXPECT_EQ(tiled.get_fence_pricing(false), serial.get_fence_pricing(false)) << number_of_threads << " threads";
+            EXPECT_EQ(tiled.get_fence_pricing(true), serial.get_fence_pricing(true)) << number_of_threads << " threads";
+        }
+    }
+
+    // A single region winding through every band.
+    Grid<char> snake(40, 5, 'A');
+    for (int r = 1; r < 40; r += 2)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            snake.at(r, (r / 2) % 2 == 0 ? c + 1 : c) = 'B';
+        }
+    }
+    Gardener serial_gardener(snake);
+    Gardener tiled_gardener(snake, 7);
+    EXPECT_EQ(tiled_gardener.get_fence_pricing(false), serial_gardener.get_fence_pricing(false));
+    EXPECT_EQ(tiled_gardener.get_fence_pricing(true), serial_gardener.get_fence_pricing(true));
+}
+
+/**
+ * @test MemoryStatsOfSharedVisitedPlots
+ * @brief Tests that all regions share one visited bitmap, so its size does not depend on the number of regions.
+ */
+TEST(GardenGroupsTest, MemoryStatsOfSharedVisitedPlots)
+{
+    auto garden = random_garden(50, 60, 1);
+    Gardener gardener(garden);
+    EXPECT_EQ(gardener.get_memory_stats().garden, 50 * 60);
+    EXPECT_EQ(gardener.get_memory_stats().region_labelling, 0);
+
+    size_t flood_fill_pricing = gardener.get_fence_pricing(false, PricingEngine::REGION_FLOOD_FILL);
+    auto stats = gardener.get_memory_stats();
+    EXPECT_EQ(stats.visited_plots, 50 * 60 * sizeof(uint32_t));
+    EXPECT_GT(stats.garden_groups, 50 * 60 * sizeof(TraversePosition));
+
+    EXPECT_EQ(gardener.get_fence_pricing(false, PricingEngine::REGION_LABELLING), flood_fill_pricing);
+    stats = gardener.get_memory_stats();
+    EXPECT_EQ(stats.region_labelling, 50 * 60 * (sizeof(uint32_t) + sizeof(RegionMeasures)));
+    EXPECT_EQ(stats.get_total(), stats.garden + stats.visited_plots + stats.garden_groups + stats.region_labelling);
+}
+
+/**
+ * @test ManagerClassAnswersRepeatedQueries
+ * @brief Tests that a single ManagerClass answers both parts, with both engines, and repeated queries.
+ */
+TEST(ManagerClassTest, ManagerClassAnswersRepeatedQueries)
+{
+    ManagerClass manager("../small_puzzle_input");
+    EXPECT_EQ(manager.get_fence_pricing(false), 1930);
+    EXPECT_EQ(manager.get_fence_pricing(true), 1206);
+    EXPECT_EQ(manager.get_fence_pricing(false, PricingEngine::REGION_FLOOD_FILL), 1930);
+    EXPECT_EQ(manager.get_fence_pricing(true, PricingEngine::REGION_FLOOD_FILL), 1206);
+    EXPECT_EQ(manager.get_fence_pricing(true, PricingEngine::REGION_FLOOD_FILL), 1206);
+    EXPECT_EQ(manager.get_fence_pricing(false), 1930);
+}
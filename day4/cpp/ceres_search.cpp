@@ -6,6 +6,9 @@
  * This program reads a puzzle input file, parses it into a 2D character array, and provides functions
  * to count the number of times "XMAS" appears horizontally, vertically, and diagonally, as well as
  * the number of "MAS" patterns in an X formation.
+ * Both counts can also be taken in a single pass over a contiguous copy of the grid, comparing a block
+ * of cells at once with SSE2, AVX2 or NEON, or one cell at a time without any of them.
+ * A dictionary of words can be counted while streaming the file row by row, without holding the grid in memory.
  */
 
 #include <iostream>
@@ -14,6 +17,110 @@
 #include <string>
 #include <stdexcept>
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <istream>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/**
+ * @namespace simd
+ * @brief Byte-wise comparisons of a block of consecutive cells, using the widest instruction set the build targets.
+ *
+ * A block holds one byte per cell. Comparisons return a block of match flags, and count returns the number of matches.
+ */
+namespace simd
+{
+#if defined(__AVX2__)
+    constexpr size_t width = 32;
+    using Bytes = __m256i;
+    inline Bytes load(const char *cells) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(cells)); }
+    inline Bytes splat(char c) { return _mm256_set1_epi8(c); }
+    inline Bytes equal(Bytes a, Bytes b) { return _mm256_cmpeq_epi8(a, b); }
+    inline Bytes both(Bytes a, Bytes b) { return _mm256_and_si256(a, b); }
+    inline Bytes either(Bytes a, Bytes b) { return _mm256_or_si256(a, b); }
+    inline size_t count(Bytes matches) { return std::popcount(static_cast<uint32_t>(_mm256_movemask_epi8(matches))); }
+#elif defined(__SSE2__)
+    constexpr size_t width = 16;
+    using Bytes = __m128i;
+    inline Bytes load(const char *cells) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(cells)); }
+    inline Bytes splat(char c) { return _mm_set1_epi8(c); }
+    inline Bytes equal(Bytes a, Bytes b) { return _mm_cmpeq_epi8(a, b); }
+    inline Bytes both(Bytes a, Bytes b) { return _mm_and_si128(a, b); }
+    inline Bytes either(Bytes a, Bytes b) { return _mm_or_si128(a, b); }
+    inline size_t count(Bytes matches) { return std::popcount(static_cast<uint32_t>(_mm_movemask_epi8(matches))); }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    constexpr size_t width = 16;
+    using Bytes = uint8x16_t;
+    inline Bytes load(const char *cells) { return vld1q_u8(reinterpret_cast<const uint8_t *>(cells)); }
+    inline Bytes splat(char c) { return vdupq_n_u8(static_cast<uint8_t>(c)); }
+    inline Bytes equal(Bytes a, Bytes b) { return vceqq_u8(a, b); }
+    inline Bytes both(Bytes a, Bytes b) { return vandq_u8(a, b); }
+    inline Bytes either(Bytes a, Bytes b) { return vorrq_u8(a, b); }
+    inline size_t count(Bytes matches) { return vaddvq_u8(vshrq_n_u8(matches, 7)); }
+#else
+    constexpr size_t width = 1;
+    using Bytes = uint8_t;
+    inline Bytes load(const char *cells) { return static_cast<uint8_t>(*cells); }
+    inline Bytes splat(char c) { return static_cast<uint8_t>(c); }
+    inline Bytes equal(Bytes a, Bytes b) { return a == b; }
+    inline Bytes both(Bytes a, Bytes b) { return a & b; }
+    inline Bytes either(Bytes a, Bytes b) { return a | b; }
+    inline size_t count(Bytes matches) { return matches; }
+#endif
+}
+
+/**
+ * @struct WordSearchCounts
+ * @brief The results of both parts of the puzzle, counted in the same pass.
+ */
+struct WordSearchCounts
+{
+    size_t xmas, mas_in_x_formation;
+};
+
+/**
+ * @class SearchGrid
+ * @brief Contiguous, row-major copy of the puzzle surrounded by padding cells that never match a letter.
+ *
+ * The padding is wide enough that the neighbours up to three cells away of any block of cells starting inside
+ * the puzzle can be loaded without bounds checks, even for a block that runs past the end of a row.
+ */
+class SearchGrid
+{
+public:
+    static constexpr size_t padding = 3;
+
+    /**
+     * @brief Copies the puzzle into the padded buffer.
+     * @param array The 2D character array representing the puzzle.
+     * @throws std::runtime_error if the rows of the puzzle differ in length.
+     */
+    SearchGrid(const std::vector<std::vector<char>> &array)
+        : rows(array.size()), cols(array.empty() ? 0 : array[0].size()), stride(padding + cols + simd::width + padding),
+          cells((rows + 2 * padding) * stride + simd::width, '.')
+    {
+        for (size_t row = 0; row < rows; ++row)
+        {
+            if (array[row].size() != cols)
+                throw std::runtime_error("All rows of the puzzle need the same length.");
+            std::copy(array[row].begin(), array[row].end(), cells.begin() + index(row, 0));
+        }
+    }
+
+    size_t index(size_t row, size_t col) const { return (row + padding) * stride + col + padding; }
+    const char *data() const { return cells.data(); }
+
+    size_t rows, cols, stride;
+
+private:
+    std::vector<char> cells;
+};
 
 /**
  * @class PuzzleInput
@@ -195,7 +302,7 @@ public:
      * @param array The 2D character array representing the puzzle.
      * @return The count of "MAS" in X formation.
      */
-    size_t count_mas_in_x_formation(const std::vector<std::vector<char>> &array)
+    size_t count_mas_in_x_formation(const std::vector<std::vector<char>> &array) const
     {
         size_t count = 0;
         int row_size = array.size();
@@ -228,6 +335,50 @@ public:
         return count;
     }
 
+    /**
+     * @brief Counts "XMAS" in all eight directions and "MAS" in an X formation in a single pass over the puzzle.
+     *
+     * The puzzle is copied into a SearchGrid once. Every block of simd::width cells is then checked as possible start of
+     * an "XMAS" in each direction, by comparing the block and the blocks one, two and three steps further in that
+     * direction with the letters of the word. The same block is checked as possible centre of an X of "MAS".
+     * @param array The 2D character array representing the puzzle.
+     * @return The count of "XMAS" in all directions and of "MAS" in X formation.
+     * @throws std::runtime_error if the rows of the puzzle differ in length.
+     */
+    WordSearchCounts count_xmas_and_mas_in_x_formation(const std::vector<std::vector<char>> &array) const
+    {
+        SearchGrid grid(array);
+        auto stride = static_cast<std::ptrdiff_t>(grid.stride);
+        const std::array<std::ptrdiff_t, 8> directions{1, -1, stride, -stride, stride + 1, stride - 1, -stride + 1, -stride - 1};
+        const simd::Bytes x = simd::splat('X'), m = simd::splat('M'), a = simd::splat('A'), s = simd::splat('S');
+
+        WordSearchCounts counts{0, 0};
+        for (size_t row = 0; row < grid.rows; ++row)
+        {
+            for (size_t col = 0; col < grid.cols; col += simd::width)
+            {
+                const char *block = grid.data() + grid.index(row, col);
+                simd::Bytes starts = simd::equal(simd::load(block), x);
+                for (auto step : directions)
+                {
+                    simd::Bytes word = simd::both(simd::both(starts, simd::equal(simd::load(block + step), m)),
+                                                  simd::both(simd::equal(simd::load(block + 2 * step), a), simd::equal(simd::load(block + 3 * step), s)));
+                    counts.xmas += simd::count(word);
+                }
+
+                // Both diagonals through an 'A' need to read "MAS" in either direction.
+                simd::Bytes up_left = simd::load(block - stride - 1), down_right = simd::load(block + stride + 1);
+                simd::Bytes up_right = simd::load(block - stride + 1), down_left = simd::load(block + stride - 1);
+                simd::Bytes falling = simd::either(simd::both(simd::equal(up_left, m), simd::equal(down_right, s)),
+                                                   simd::both(simd::equal(up_left, s), simd::equal(down_right, m)));
+                simd::Bytes rising = simd::either(simd::both(simd::equal(up_right, m), simd::equal(down_left, s)),
+                                                  simd::both(simd::equal(up_right, s), simd::equal(down_left, m)));
+                counts.mas_in_x_formation += simd::count(simd::both(simd::equal(simd::load(block), a), simd::both(falling, rising)));
+            }
+        }
+        return counts;
+    }
+
 private:
     /**
      * @brief Counts the number of times a substring appears in a string (overlapping allowed).
@@ -250,22 +401,198 @@ private:
     }
 };
 
+/**
+ * @class StreamingWordSearch
+ * @brief Counts a dictionary of words in all eight directions in a single streaming pass over a puzzle.
+ *
+ * The words and their reverses form an Aho-Corasick automaton, so reading a line forwards finds the words in both
+ * directions of that line. Every row is read to the right, and every column and both diagonals are read downwards
+ * by keeping one automaton state per line. The state stands for the previous cells of its line that can still be part
+ * of a match, never more than the longest word, so only the states of the previous row are kept instead of the rows
+ * themselves.
+ */
+class StreamingWordSearch
+{
+public:
+    /**
+     * @brief Builds the automaton for a dictionary of words.
+     * @param words The words to count, a word may appear more than once.
+     * @throws std::invalid_argument if there are no words or a word is empty.
+     */
+    StreamingWordSearch(const std::vector<std::string> &words)
+        : number_of_words(words.size()), transitions(1), failure(1, 0)
+    {
+        if (words.empty())
+            throw std::invalid_argument("Error: The word search needs at least one word.");
+        for (const auto &word : words)
+        {
+            if (word.empty())
+                throw std::invalid_argument("Error: The words of the word search may not be empty.");
+            word_states.push_back(insert(word));
+            word_states.push_back(insert(std::string(word.rbegin(), word.rend())));
+        }
+        build_failure_links();
+    }
+
+    /**
+     * @brief Counts every word in all eight directions of a puzzle, reading it once row by row.
+     *
+     * A palindrome is found once in either direction of a line, just like a word read backwards is.
+     * @param input The stream of the puzzle, one row per line. Empty lines are skipped.
+     * @return The count of every word, in the order the words were given.
+     * @throws std::runtime_error if the rows of the puzzle differ in length.
+     */
+    std::vector<size_t> count_words(std::istream &input) const
+    {
+        std::vector<size_t> visits(transitions.size(), 0);
+        std::vector<uint32_t> falling, rising, vertical, next_falling, next_rising;
+        std::string line;
+        size_t cols = 0;
+        while (std::getline(input, line))
+        {
+            if (line.empty())
+                continue;
+            if (vertical.empty())
+            {
+                cols = line.size();
+                falling.assign(cols, 0);
+                rising.assign(cols, 0);
+                vertical.assign(cols, 0);
+                next_falling.resize(cols);
+                next_rising.resize(cols);
+            }
+            else if (line.size() != cols)
+            {
+                throw std::runtime_error("All rows of the puzzle need the same length.");
+            }
+
+            uint32_t horizontal = 0;
+            for (size_t col = 0; col < cols; ++col)
+            {
+                auto cell = static_cast<unsigned char>(line[col]);
+                horizontal = transitions[horizontal][cell];
+                vertical[col] = transitions[vertical[col]][cell];
+                next_falling[col] = transitions[col > 0 ? falling[col - 1] : 0][cell];
+                next_rising[col] = transitions[col + 1 < cols ? rising[col + 1] : 0][cell];
+                ++visits[horizontal];
+                ++visits[vertical[col]];
+                ++visits[next_falling[col]];
+                ++visits[next_rising[col]];
+            }
+            falling.swap(next_falling);
+            rising.swap(next_rising);
+        }
+
+        // A visit to a state is a visit to every shorter suffix of it as well, so hand the visits down the failure links.
+        for (auto state = breadth_first_order.rbegin(); state != breadth_first_order.rend(); ++state)
+        {
+            visits[failure[*state]] += visits[*state];
+        }
+        std::vector<size_t> counts(number_of_words);
+        for (size_t word = 0; word < number_of_words; ++word)
+        {
+            counts[word] = visits[word_states[2 * word]] + visits[word_states[2 * word + 1]];
+        }
+        return counts;
+    }
+
+private:
+    using Transitions = std::array<uint32_t, 256>;
+
+    size_t number_of_words;
+    std::vector<Transitions> transitions;
+    std::vector<uint32_t> failure, word_states, breadth_first_order;
+
+    /**
+     * @brief Adds a word to the trie of the automaton.
+     * @param word The word to add.
+     * @return The state reached after reading the word.
+     */
+    uint32_t insert(const std::string &word)
+    {
+        uint32_t state = 0;
+        for (char c : word)
+        {
+            auto cell = static_cast<unsigned char>(c);
+            if (transitions[state][cell] == 0)
+            {
+                transitions[state][cell] = static_cast<uint32_t>(transitions.size());
+                transitions.emplace_back();
+                failure.push_back(0);
+            }
+            state = transitions[state][cell];
+        }
+        return state;
+    }
+
+    /**
+     * @brief Computes the failure links breadth first and completes the trie to a transition for every state and cell.
+     */
+    void build_failure_links()
+    {
+        breadth_first_order.clear();
+        for (uint32_t next : transitions[0])
+        {
+            if (next != 0)
+                breadth_first_order.push_back(next);
+        }
+        for (size_t i = 0; i < breadth_first_order.size(); ++i)
+        {
+            uint32_t state = breadth_first_order[i];
+            for (size_t cell = 0; cell < 256; ++cell)
+            {
+                uint32_t &next = transitions[state][cell];
+                uint32_t fallback = transitions[failure[state]][cell];
+                if (next == 0)
+                {
+                    next = fallback;
+                }
+                else
+                {
+                    failure[next] = fallback;
+                    breadth_first_order.push_back(next);
+                }
+            }
+        }
+    }
+};
+
 /**
  * @brief Main function. Reads the puzzle input, parses it, and prints the results for both parts.
+ *
+ * Usage: ceres_search [puzzle_input [word...]]. Given words, it streams the puzzle and prints the count of every word instead.
  */
-int main()
+int main(int argc, char *argv[])
 {
     try
     {
-        PuzzleInput input_handler;
+        std::string filename = argc > 1 ? argv[1] : "../puzzle_input";
+        if (argc > 2)
+        {
+            std::vector<std::string> words(argv + 2, argv + argc);
+            std::ifstream infile(filename);
+            if (!infile)
+                throw std::runtime_error("Error: The file " + filename + " does not exist.");
+
+            StreamingWordSearch word_search(words);
+            std::vector<size_t> counts = word_search.count_words(infile);
+            for (size_t word = 0; word < words.size(); ++word)
+            {
+                std::cout << words[word] << ": " << counts[word] << std::endl;
+            }
+            return 0;
+        }
+
+        PuzzleInput input_handler(filename);
         std::vector<std::vector<char>> puzzle_array = input_handler.parse_input();
 
         CeresSearch ceres_search;
+        WordSearchCounts counts = ceres_search.count_xmas_and_mas_in_x_formation(puzzle_array);
         std::cout << "Part 1:" << std::endl;
-        std::cout << ceres_search.count_xmas_all(puzzle_array) << std::endl;
+        std::cout << counts.xmas << std::endl;
 
         std::cout << "Part 2:" << std::endl;
-        std::cout << ceres_search.count_mas_in_x_formation(puzzle_array) << std::endl;
+        std::cout << counts.mas_in_x_formation << std::endl;
     }
     catch (const std::exception &ex)
     {
@@ -0,0 +1,50 @@
+#include "bench.hpp"
+#include "guard_gallivant.hpp"
+
+/**
+ * @brief Generates a lab map with about 5 % obstacles and the guard in the centre, facing up.
+ * @param size The number of rows and columns.
+ */
+std::string generate_lab_map(bench::Generator &generator, size_t size)
+{
+    return generator.grid(size, size, [size](bench::Generator &g, size_t r, size_t c, const std::string &)
+                          {
+        if (r == size / 2 && c == size / 2)
+            return '^';
+        return g.chance(0.05) ? '#' : '.'; });
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        bench::Suite suite("Guard Gallivant", argc, argv);
+        bench::Generator generator;
+        for (size_t size : {32 * suite.get_scale(), 128 * suite.get_scale()})
+        {
+            std::string label = "@" + std::to_string(size) + "x" + std::to_string(size);
+            std::string filename = bench::write_input("build/bench_lab_map_" + label.substr(1), generate_lab_map(generator, size));
+
+            suite.run("patrolled_positions" + label, [&]
+                      { return ManagerClass(filename).get_number_of_patrolled_positions(); });
+            for (size_t number_of_threads : {1, 0})
+            {
+                suite.run("obstructions" + label + "/threads=" + std::to_string(number_of_threads), [&]
+                          { return ManagerClass(filename, number_of_threads).get_number_of_obstructions_for_guard_loops(); });
+            }
+            suite.run("both_parts" + label + "/MANAGER_PER_PART", [&]
+                      { return ManagerClass(filename).get_number_of_patrolled_positions() +
+                               ManagerClass(filename).get_number_of_obstructions_for_guard_loops(); });
+            suite.run("both_parts" + label + "/SESSION", [&]
+                      {
+                          ManagerClass manager(filename);
+                          return manager.get_number_of_patrolled_positions() + manager.get_number_of_obstructions_for_guard_loops(); });
+        }
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -11,7 +11,18 @@
 #include <unordered_set>
 #include <map>
 #include <algorithm>
-// #include <thread>
+#include <atomic>
+#include <thread>
+#include "grid_file.hpp"
+#include "instrumentation.hpp"
+
+static instrumentation::Counter steps_simulated("steps_simulated");
+static instrumentation::Counter obstacle_jumps("obstacle_jumps");
+static instrumentation::Counter obstruction_candidates_checked("obstruction_candidates_checked");
+static instrumentation::Counter guard_loops_found("guard_loops_found");
+static instrumentation::Phase parse_phase("parse");
+static instrumentation::Phase compute_phase("compute");
+static instrumentation::Phase reduce_phase("reduce");
 
 /**
  * @brief Constructs a GuardMovement object.
@@ -75,11 +86,30 @@ char *OutOfBoundsException::what()
  * @brief Computes the next guard movement based on the current state and map.
  * @param current The current GuardMovement.
  * @param map The 2D map.
+ * @param extra_obstruction Optional position treated as an obstacle without modifying the map.
  * @return The next GuardMovement.
  * @throws OutOfBoundsException if the guard moves out of bounds.
  * @throws std::invalid_argument if the direction is invalid.
  */
-GuardMovement GuardBehaviour::patrol_area(const GuardMovement &current, const std::vector<std::vector<char>> &map)
+GuardMovement GuardBehaviour::patrol_area(const GuardMovement &current, const Grid<char> &map, const std::optional<Position> &extra_obstruction)
+{
+    auto next = try_patrol_area(current, map, extra_obstruction);
+    if (!next)
+    {
+        throw OutOfBoundsException();
+    }
+    return *next;
+}
+
+/**
+ * @brief Computes the next guard movement, reporting a guard leaving the map with a return value instead of an exception.
+ * @param current The current GuardMovement.
+ * @param map The 2D map.
+ * @param extra_obstruction Optional position treated as an obstacle without modifying the map.
+ * @return The next GuardMovement, or std::nullopt if the guard moves out of bounds.
+ * @throws std::invalid_argument if the direction is invalid.
+ */
+std::optional<GuardMovement> GuardBehaviour::try_patrol_area(const GuardMovement &current, const Grid<char> &map, const std::optional<Position> &extra_obstruction)
 {
     auto it = direction_map().find(current.direction);
     if (it == direction_map().end())
@@ -94,10 +124,10 @@ GuardMovement GuardBehaviour::patrol_area(const GuardMovement &current, const st
 
     if (guard_is_out_of_bounds(new_x, new_y, map))
     {
-        throw OutOfBoundsException();
+        return std::nullopt;
     }
 
-    if (map[new_y][new_x] == '#')
+    if (map.at(new_y, new_x) == '#' || (extra_obstruction && extra_obstruction->x_position == new_x && extra_obstruction->y_position == new_y))
     {
         return GuardMovement(current.x_position, current.y_position, handle_obstacle_encounter(current.direction));
     }
@@ -105,6 +135,47 @@ GuardMovement GuardBehaviour::patrol_area(const GuardMovement &current, const st
     return GuardMovement(new_x, new_y, current.direction);
 }
 
+/**
+ * @brief Moves the guard straight to the next obstacle in its direction and turns it.
+ * @param current The current GuardMovement.
+ * @param jump_table The next-obstacle index of the map.
+ * @param extra_obstruction Optional position treated as an obstacle without modifying the map.
+ * @return The GuardMovement at the turning point, or std::nullopt if the guard leaves the map.
+ * @throws std::invalid_argument if the direction is invalid.
+ */
+std::optional<GuardMovement> GuardBehaviour::jump_to_next_obstacle(const GuardMovement &current, const ObstacleJumpTable &jump_table, const std::optional<Position> &extra_obstruction)
+{
+    auto stop = jump_table.find_stop_position(current, extra_obstruction);
+    if (!stop)
+    {
+        return std::nullopt;
+    }
+    return GuardMovement(stop->x_position, stop->y_position, handle_obstacle_encounter(current.direction));
+}
+
+/**
+ * @brief Maps a direction character to its index in clockwise order starting from up.
+ * @param direction The direction character ('^', '>', 'v', '<').
+ * @return The direction index (0-3).
+ * @throws std::invalid_argument if the direction is invalid.
+ */
+size_t GuardBehaviour::direction_index(char direction)
+{
+    switch (direction)
+    {
+    case '^':
+        return 0;
+    case '>':
+        return 1;
+    case 'v':
+        return 2;
+    case '<':
+        return 3;
+    default:
+        throw std::invalid_argument("Invalid guard direction");
+    }
+}
+
 /**
  * @brief Returns the static direction map.
  * @return A map from direction char to (dx, dy) pair.
@@ -148,41 +219,216 @@ char GuardBehaviour::handle_obstacle_encounter(const char &direction)
  * @param map The 2D map.
  * @return True if out of bounds, false otherwise.
  */
-bool GuardBehaviour::guard_is_out_of_bounds(const int &new_x, const int &new_y, const std::vector<std::vector<char>> &map)
+bool GuardBehaviour::guard_is_out_of_bounds(const int &new_x, const int &new_y, const Grid<char> &map)
+{
+    return !map.contains(new_y, new_x);
+}
+
+/**
+ * @brief Builds the next-obstacle index by sweeping every row and column once in each direction.
+ * @param map The 2D map.
+ */
+ObstacleJumpTable::ObstacleJumpTable(const Grid<char> &map)
+    : width(map.get_cols()),
+      height(map.get_rows()),
+      stops(width * height * 4, -1)
 {
-    if (new_x < 0 or (size_t) new_x > map.size() - 1)
+    const size_t up = GuardBehaviour::direction_index('^');
+    const size_t right = GuardBehaviour::direction_index('>');
+    const size_t down = GuardBehaviour::direction_index('v');
+    const size_t left = GuardBehaviour::direction_index('<');
+
+    for (size_t x = 0; x < width; x++)
     {
-        return true;
+        int stop = -1;
+        for (size_t y = 0; y < height; y++)
+        {
+            stops[(y * width + x) * 4 + up] = stop;
+            if (map.at(y, x) == '#')
+                stop = y + 1;
+        }
+        stop = -1;
+        for (size_t y = height; y-- > 0;)
+        {
+            stops[(y * width + x) * 4 + down] = stop;
+            if (map.at(y, x) == '#')
+                stop = (int)y - 1;
+        }
     }
-    if (new_y < 0 or (size_t) new_y > map[0].size() - 1)
+    for (size_t y = 0; y < height; y++)
     {
-        return true;
+        int stop = -1;
+        for (size_t x = 0; x < width; x++)
+        {
+            stops[(y * width + x) * 4 + left] = stop;
+            if (map.at(y, x) == '#')
+                stop = x + 1;
+        }
+        stop = -1;
+        for (size_t x = width; x-- > 0;)
+        {
+            stops[(y * width + x) * 4 + right] = stop;
+            if (map.at(y, x) == '#')
+                stop = (int)x - 1;
+        }
     }
-    return false;
 }
 
 /**
- * @brief Constructs a GuardSimulation with the given map and initial guard movement.
- * @param starting_map The 2D map.
- * @param initial_guard_movement The guard's starting position and direction.
+ * @brief Finds the position where the guard has to stop in front of the next obstacle.
+ *
+ * The extra obstruction only matters if it lies between the guard and the obstacle from the table.
+ * @param current The current GuardMovement.
+ * @param extra_obstruction Optional position treated as an obstacle without modifying the table.
+ * @return The stop position, or std::nullopt if the guard leaves the map.
+ * @throws std::invalid_argument if the direction is invalid.
+ */
+std::optional<Position> ObstacleJumpTable::find_stop_position(const GuardMovement &current, const std::optional<Position> &extra_obstruction) const
+{
+    const int x = current.x_position;
+    const int y = current.y_position;
+    int stop = stops[((size_t)y * width + (size_t)x) * 4 + GuardBehaviour::direction_index(current.direction)];
+
+    switch (current.direction)
+    {
+    case '^':
+        if (extra_obstruction && extra_obstruction->x_position == x && extra_obstruction->y_position < y && extra_obstruction->y_position >= stop)
+            stop = extra_obstruction->y_position + 1;
+        break;
+    case 'v':
+        if (extra_obstruction && extra_obstruction->x_position == x && extra_obstruction->y_position > y && (stop == -1 || extra_obstruction->y_position <= stop))
+            stop = extra_obstruction->y_position - 1;
+        break;
+    case '<':
+        if (extra_obstruction && extra_obstruction->y_position == y && extra_obstruction->x_position < x && extra_obstruction->x_position >= stop)
+            stop = extra_obstruction->x_position + 1;
+        break;
+    case '>':
+        if (extra_obstruction && extra_obstruction->y_position == y && extra_obstruction->x_position > x && (stop == -1 || extra_obstruction->x_position <= stop))
+            stop = extra_obstruction->x_position - 1;
+        break;
+    }
+
+    if (stop == -1)
+        return std::nullopt;
+    if (current.direction == '^' || current.direction == 'v')
+        return Position(x, stop);
+    return Position(stop, y);
+}
+
+/**
+ * @brief Constructs an empty VisitedStateGrid for a map of the given size.
+ * @param width The number of columns of the map.
+ * @param height The number of rows of the map.
+ */
+VisitedStateGrid::VisitedStateGrid(size_t width, size_t height)
+    : width(width),
+      height(height),
+      generation(1),
+      movement_stamps(width * height * 4, 0),
+      position_stamps(width * height, 0) {}
+
+/**
+ * @brief Forgets all visited states by starting a new generation.
+ *
+ * The stamps are only cleared when the generation counter wraps around.
+ */
+void VisitedStateGrid::reset()
+{
+    if (++generation == 0)
+    {
+        std::fill(movement_stamps.begin(), movement_stamps.end(), 0);
+        std::fill(position_stamps.begin(), position_stamps.end(), 0);
+        generation = 1;
+    }
+}
+
+/**
+ * @brief Marks a guard movement (position and direction) as visited.
+ * @param gm The GuardMovement to mark.
+ * @return True if the movement was not visited before, false otherwise.
+ */
+bool VisitedStateGrid::visit(const GuardMovement &gm)
+{
+    uint32_t &stamp = movement_stamps[((size_t)gm.y_position * width + (size_t)gm.x_position) * 4 + GuardBehaviour::direction_index(gm.direction)];
+    if (stamp == generation)
+        return false;
+    stamp = generation;
+    return true;
+}
+
+/**
+ * @brief Marks a position as visited, regardless of direction.
+ * @param x The x (#columns) position.
+ * @param y The y (#rows) position.
+ */
+void VisitedStateGrid::visit_position(int x, int y)
+{
+    position_stamps[(size_t)y * width + (size_t)x] = generation;
+}
+
+/**
+ * @brief Checks if a position has been visited in the current generation.
+ * @param x The x (#columns) position.
+ * @param y The y (#rows) position.
+ * @return True if the position has been visited.
+ */
+bool VisitedStateGrid::contains_position(int x, int y) const
+{
+    return position_stamps[(size_t)y * width + (size_t)x] == generation;
+}
+
+/**
+ * @brief Collects all positions visited in the current generation.
+ * @return An unordered_set of Position objects.
  */
-GuardSimulation::GuardSimulation(std::vector<std::vector<char>> starting_map, GuardMovement initial_guard_movement)
-    : map(std::move(starting_map)),
-      initial_guard_movement(std::move(initial_guard_movement))
+std::unordered_set<Position> VisitedStateGrid::get_visited_positions() const
 {
-    visited_positions_with_direction.insert(this->initial_guard_movement);
-    visited_positions.insert(Position(this->initial_guard_movement.x_position, this->initial_guard_movement.y_position));
+    std::unordered_set<Position> positions;
+    for (size_t y = 0; y < height; y++)
+    {
+        for (size_t x = 0; x < width; x++)
+        {
+            if (position_stamps[y * width + x] == generation)
+                positions.insert(Position(x, y));
+        }
+    }
+    return positions;
 }
 
+/**
+ * @brief Constructs a GuardSimulation with the given map and initial guard movement.
+ * @param starting_map The 2D map, which must outlive the simulation. It is only read, so it can be shared between simulations.
+ * @param initial_guard_movement The guard's starting position and direction.
+ * @param jump_table Optional next-obstacle index of the map. If given, loop detection jumps between obstacles instead of stepping.
+ */
+GuardSimulation::GuardSimulation(const Grid<char> &starting_map, GuardMovement initial_guard_movement, const ObstacleJumpTable *jump_table)
+    : map(starting_map),
+      jump_table(jump_table),
+      visited_states(starting_map.get_cols(), starting_map.get_rows()),
+      initial_guard_movement(std::move(initial_guard_movement)) {}
+
 /**
  * @brief Returns the set of all positions patrolled by the guard.
  * @return An unordered_set of Position objects.
  */
 std::unordered_set<Position> GuardSimulation::get_patrolled_area()
 {
-    guard_patrols_area_and_leaves_map();
+    guard_patrols_area_and_leaves_map(initial_guard_movement, true);
     // print_patrolled_area(current_guard_movement);
-    return visited_positions;
+    return visited_states.get_visited_positions();
+}
+
+/**
+ * @brief Returns every state of the guard's patrol in order, starting with the initial guard movement.
+ *
+ * Turning on an obstacle is recorded as its own state with the same position and a new direction.
+ * @return A vector of GuardMovement objects.
+ */
+std::vector<GuardMovement> GuardSimulation::get_patrol_trajectory()
+{
+    guard_patrols_area_and_leaves_map(initial_guard_movement, true);
+    return patrol_trajectory;
 }
 
 /**
@@ -191,45 +437,131 @@ std::unordered_set<Position> GuardSimulation::get_patrolled_area()
  */
 bool GuardSimulation::results_in_loop()
 {
-    return !guard_patrols_area_and_leaves_map();
+    return results_in_loop_from(initial_guard_movement);
+}
+
+/**
+ * @brief Determines if the simulation results in a loop when an extra obstruction is placed on the map.
+ *
+ * The map itself is never modified, so the same simulation can be reused for many candidate obstructions.
+ * @param obstruction The position of the extra obstruction.
+ * @return True if a loop is detected, false otherwise.
+ */
+bool GuardSimulation::results_in_loop_with_obstruction(const Position &obstruction)
+{
+    return results_in_loop_with_obstruction(obstruction, initial_guard_movement);
+}
+
+/**
+ * @brief Determines if the simulation results in a loop when an extra obstruction is placed on the map,
+ * resuming the patrol from a given guard movement instead of the initial one.
+ *
+ * Resuming is only valid from a state on the original patrol before the obstruction is first reached,
+ * since the patrol up to that point is unaffected by the obstruction.
+ * @param obstruction The position of the extra obstruction.
+ * @param resume_guard_movement The guard's state to resume the patrol from.
+ * @return True if a loop is detected, false otherwise.
+ */
+bool GuardSimulation::results_in_loop_with_obstruction(const Position &obstruction, const GuardMovement &resume_guard_movement)
+{
+    extra_obstruction = obstruction;
+    bool loop = results_in_loop_from(resume_guard_movement);
+    extra_obstruction.reset();
+    return loop;
+}
+
+/**
+ * @brief Determines if the patrol starting from a given guard movement results in a loop.
+ *
+ * Jumps between obstacles when a jump table is available, otherwise steps one position at a time.
+ * @param start_guard_movement The guard's state to start the patrol from.
+ * @return True if a loop is detected, false otherwise.
+ */
+bool GuardSimulation::results_in_loop_from(const GuardMovement &start_guard_movement)
+{
+    if (jump_table)
+        return !guard_jumps_between_obstacles_and_leaves_map(start_guard_movement);
+    return !guard_patrols_area_and_leaves_map(start_guard_movement, false);
 }
 
 /**
  * @brief Simulates the guard's patrol, tracking visited positions and detecting loops.
+ * @param start_guard_movement The guard's state to start the patrol from.
+ * @param record_patrolled_area Whether to also record the visited positions without direction and the ordered trajectory.
  * @return True if the guard leaves the map, false if a loop is detected.
  */
-bool GuardSimulation::guard_patrols_area_and_leaves_map()
+bool GuardSimulation::guard_patrols_area_and_leaves_map(const GuardMovement &start_guard_movement, bool record_patrolled_area)
 {
-    GuardMovement current_guard_movement = initial_guard_movement;
-    visited_positions_with_direction.clear();
-    visited_positions_with_direction.insert(current_guard_movement);
-
+    GuardMovement current_guard_movement = start_guard_movement;
+    visited_states.reset();
+    visited_states.visit(current_guard_movement);
+    visited_states.visit_position(current_guard_movement.x_position, current_guard_movement.y_position);
+    patrol_trajectory.clear();
+    if (record_patrolled_area)
+        patrol_trajectory.push_back(current_guard_movement);
+
+    size_t steps = 0;
     while (true)
     {
-        try
+        auto next_guard_movement = GuardBehaviour::try_patrol_area(current_guard_movement, map, extra_obstruction);
+        if (!next_guard_movement)
         {
-            // std::cout << current_guard_movement << "\n";
-            GuardMovement next_guard_movement = GuardBehaviour::patrol_area(current_guard_movement, map);
-
-            if (visited_positions_with_direction.count(next_guard_movement))
-            {
-                // Loop detected if this position+direction is already visited
-                break;
-            }
+            steps_simulated.add(steps);
+            return true;
+        }
+        ++steps;
 
-            visited_positions_with_direction.insert(next_guard_movement);
-            visited_positions.insert(Position(next_guard_movement.x_position, next_guard_movement.y_position));
-            current_guard_movement = next_guard_movement;
+        if (!visited_states.visit(*next_guard_movement))
+        {
+            // Loop detected if this position+direction is already visited
+            break;
         }
-        catch (const OutOfBoundsException &e)
+
+        if (record_patrolled_area)
         {
-            return true;
+            visited_states.visit_position(next_guard_movement->x_position, next_guard_movement->y_position);
+            patrol_trajectory.push_back(*next_guard_movement);
         }
+        current_guard_movement = *next_guard_movement;
     }
 
+    steps_simulated.add(steps);
     return false;
 }
 
+/**
+ * @brief Simulates the guard's patrol using only the turning points, detecting loops.
+ *
+ * A loop always passes through at least one obstacle, so it can be detected from the turning states alone.
+ * @param start_guard_movement The guard's state to start the patrol from.
+ * @return True if the guard leaves the map, false if a loop is detected.
+ */
+bool GuardSimulation::guard_jumps_between_obstacles_and_leaves_map(const GuardMovement &start_guard_movement)
+{
+    GuardMovement current_guard_movement = start_guard_movement;
+    visited_states.reset();
+
+    size_t jumps = 0;
+    while (true)
+    {
+        auto next_guard_movement = GuardBehaviour::jump_to_next_obstacle(current_guard_movement, *jump_table, extra_obstruction);
+        if (!next_guard_movement)
+        {
+            obstacle_jumps.add(jumps);
+            return true;
+        }
+        ++jumps;
+
+        if (!visited_states.visit(*next_guard_movement))
+        {
+            // Loop detected if this turning point was already visited in the same direction
+            obstacle_jumps.add(jumps);
+            return false;
+        }
+        current_guard_movement = *next_guard_movement;
+    }
+}
+
 /**
  * @brief Prints the patrolled area, marking the guard's current position and visited positions.
  * @param current_guard_movement The current GuardMovement.
@@ -237,29 +569,40 @@ bool GuardSimulation::guard_patrols_area_and_leaves_map()
 void GuardSimulation::print_patrolled_area(GuardMovement current_guard_movement)
 {
 
-    for (size_t y = 0; y < map.size(); y++)
+    for (size_t y = 0; y < map.get_rows(); y++)
     {
-        for (size_t x = 0; x < map[0].size(); x++)
+        for (size_t x = 0; x < map.get_cols(); x++)
         {
             if ((size_t)current_guard_movement.x_position == x && (size_t)current_guard_movement.y_position == y)
                 std::cout << current_guard_movement.direction;
-            else if (visited_positions.contains(Position(x, y)))
+            else if (visited_states.contains_position(x, y))
                 std::cout << '~';
             else
-                std::cout << map[y][x];
+                std::cout << map.at(y, x);
         }
         std::cout << "\n";
     }
 }
 
+/**
+ * @brief Constructs an ObstructionCandidate.
+ * @param position The position to obstruct.
+ * @param resume_guard_movement The guard's state just before it first enters the position.
+ */
+ObstructionCandidate::ObstructionCandidate(const Position &position, const GuardMovement &resume_guard_movement)
+    : position(position), resume_guard_movement(resume_guard_movement) {}
+
 /**
  * @brief Constructs a ManagerClass, reads the map, and finds the guard's starting position.
  * @param input_file_name The path to the input file.
+ * @param number_of_threads Number of worker threads used for the obstruction search (0 = hardware concurrency).
  * @throws std::runtime_error if the map is empty or invalid.
  */
-ManagerClass::ManagerClass(const std::string &input_file_name)
+ManagerClass::ManagerClass(const std::string &input_file_name, size_t number_of_threads)
     : starting_map(read_input(input_file_name)),
-      initial_guard_movement(find_guard_in_map(starting_map))
+      initial_guard_movement(find_guard_in_map(starting_map)),
+      jump_table(starting_map),
+      number_of_threads(number_of_threads != 0 ? number_of_threads : std::max(1u, std::thread::hardware_concurrency()))
 {
     if (starting_map.empty())
     {
@@ -269,28 +612,123 @@ ManagerClass::ManagerClass(const std::string &input_file_name)
 
 /**
  * @brief Returns all positions that, if obstructed, would cause the guard to loop.
+ *
+ * Only positions on the guard's original patrol can change its path, so those are the candidates.
+ * The candidates are shared between number_of_threads workers, which all read the same starting map.
+ * The positions are searched on the first call only, later calls return the cached result.
  * @return An unordered_set of Position objects.
  */
 std::unordered_set<Position> ManagerClass::get_all_possible_obstructions_to_create_guard_loops()
 {
-    // Get all positions patrolled by the guard
-    std::unordered_set<Position> visited_positions = get_patrolled_area();
+    if (guard_loop_positions)
+        return *guard_loop_positions;
+
+    const std::vector<ObstructionCandidate> &candidates = get_obstruction_candidates();
+    std::optional<instrumentation::ScopedTimer> compute_timer(compute_phase);
+    std::atomic<size_t> next_candidate{0};
+
+    size_t workers = std::min(number_of_threads, candidates.size());
+    std::vector<std::vector<Position>> loop_positions_per_worker(std::max<size_t>(workers, 1));
+    if (workers <= 1)
+    {
+        loop_positions_per_worker[0] = search_obstruction_candidates(candidates, next_candidate);
+    }
+    else
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(workers);
+        for (size_t worker = 0; worker < workers; ++worker)
+        {
+            threads.emplace_back([&, worker]()
+                                 { loop_positions_per_worker[worker] = search_obstruction_candidates(candidates, next_candidate); });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+    }
+    compute_timer.reset();
+
+    instrumentation::ScopedTimer reduce_timer(reduce_phase);
     std::unordered_set<Position> loop_positions;
+    for (const auto &found : loop_positions_per_worker)
+    {
+        loop_positions.insert(found.begin(), found.end());
+    }
+    guard_loop_positions = std::move(loop_positions);
+    return *guard_loop_positions;
+}
+
+/**
+ * @brief Returns the obstruction candidates on the guard's original patrol, found on the first call and cached.
+ * @return A vector of ObstructionCandidate objects, in the order they are first visited.
+ */
+const std::vector<ObstructionCandidate> &ManagerClass::get_obstruction_candidates()
+{
+    if (!obstruction_candidates)
+    {
+        instrumentation::ScopedTimer compute_timer(compute_phase);
+        obstruction_candidates = find_obstruction_candidates();
+    }
+    return *obstruction_candidates;
+}
+
+/**
+ * @brief Finds every position on the guard's original patrol, paired with the state just before the guard first enters it.
+ *
+ * The starting position is never entered, so its simulation resumes from the initial guard movement.
+ * @return A vector of ObstructionCandidate objects, in the order they are first visited.
+ */
+std::vector<ObstructionCandidate> ManagerClass::find_obstruction_candidates()
+{
+    std::vector<GuardMovement> trajectory = GuardSimulation(starting_map, initial_guard_movement).get_patrol_trajectory();
+    std::vector<bool> first_visit_found(starting_map.size(), false);
+    std::vector<ObstructionCandidate> candidates;
+
+    for (size_t idx = 0; idx < trajectory.size(); ++idx)
+    {
+        const GuardMovement &gm = trajectory[idx];
+        size_t cell = starting_map.index(gm.y_position, gm.x_position);
+        if (first_visit_found[cell])
+            continue;
+        first_visit_found[cell] = true;
+        candidates.emplace_back(Position(gm.x_position, gm.y_position), idx == 0 ? gm : trajectory[idx - 1]);
+    }
+    return candidates;
+}
+
+/**
+ * @brief Tests candidate obstructions until all candidates have been claimed.
+ *
+ * Candidates are claimed in small chunks from a shared counter, which keeps the workers balanced
+ * since the cost of a candidate varies with the length of its patrol.
+ * Each call owns a single GuardSimulation that is reused for all its candidates, so the map is never copied.
+ * Each simulation resumes from the candidate's first visit instead of replaying the unchanged start of the patrol.
+ * @param candidates The positions to place an obstruction on, one at a time.
+ * @param next_candidate Index of the next unclaimed candidate, shared between workers.
+ * @return The claimed candidates that cause the guard to loop.
+ */
+std::vector<Position> ManagerClass::search_obstruction_candidates(const std::vector<ObstructionCandidate> &candidates, std::atomic<size_t> &next_candidate)
+{
+    const size_t chunk_size = 16;
+    std::vector<Position> loop_positions;
+    GuardSimulation sim(starting_map, initial_guard_movement, &jump_table);
 
-    // TODO: Add threadpool here
-    for (const auto &pos : visited_positions)
+    size_t start;
+    while ((start = next_candidate.fetch_add(chunk_size)) < candidates.size())
     {
-        // Make a copy of the map
-        std::vector<std::vector<char>> map_with_obstacle = starting_map;
-        // Place an obstacle at the visited position
-        map_with_obstacle[pos.y_position][pos.x_position] = '#';
-        // Run the simulation with the new map
-        GuardSimulation sim(map_with_obstacle, initial_guard_movement);
-        if (sim.results_in_loop())
+        size_t end = std::min(start + chunk_size, candidates.size());
+        for (size_t idx = start; idx < end; ++idx)
         {
-            loop_positions.insert(pos);
+            const ObstructionCandidate &candidate = candidates[idx];
+            if (sim.results_in_loop_with_obstruction(candidate.position, candidate.resume_guard_movement))
+            {
+                loop_positions.push_back(candidate.position);
+            }
         }
+        obstruction_candidates_checked.add(end - start);
     }
+    guard_loops_found.add(loop_positions.size());
     return loop_positions;
 }
 
@@ -300,16 +738,27 @@ std::unordered_set<Position> ManagerClass::get_all_possible_obstructions_to_crea
  */
 size_t ManagerClass::get_number_of_obstructions_for_guard_loops()
 {
-    return get_all_possible_obstructions_to_create_guard_loops().size();
+    if (!guard_loop_positions)
+        get_all_possible_obstructions_to_create_guard_loops();
+    return guard_loop_positions->size();
 }
 
 /**
  * @brief Returns the set of all positions patrolled by the guard.
+ *
+ * Every patrolled position is exactly one obstruction candidate, so the area comes from the cached candidates.
  * @return An unordered_set of Position objects.
  */
 std::unordered_set<Position> ManagerClass::get_patrolled_area()
 {
-    return GuardSimulation(starting_map, initial_guard_movement).get_patrolled_area();
+    const std::vector<ObstructionCandidate> &candidates = get_obstruction_candidates();
+    std::unordered_set<Position> patrolled_area;
+    patrolled_area.reserve(candidates.size());
+    for (const auto &candidate : candidates)
+    {
+        patrolled_area.insert(candidate.position);
+    }
+    return patrolled_area;
 }
 
 /**
@@ -318,31 +767,20 @@ std::unordered_set<Position> ManagerClass::get_patrolled_area()
  */
 size_t ManagerClass::get_number_of_patrolled_positions()
 {
-    return get_patrolled_area().size();
+    return get_obstruction_candidates().size();
 }
 
 /**
  * @brief Reads the content of the input file.
  * @param filename The path to the input file.
- * @return A 2D vector of characters representing the puzzle.
- * @throws std::runtime_error if the file does not exist.
+ * @return A grid of characters representing the puzzle.
+ * @throws std::runtime_error if the file does not exist or is empty.
+ * @throws std::invalid_argument if the lines of the file differ in length.
  */
-std::vector<std::vector<char>> ManagerClass::read_input(const std::string &filename)
+Grid<char> ManagerClass::read_input(const std::string &filename)
 {
-
-    std::vector<std::vector<char>> array;
-    std::ifstream infile(filename);
-    if (!infile)
-    {
-        throw std::runtime_error("Error: The file " + filename + " does not exist.");
-    }
-    std::string line;
-    while (std::getline(infile, line))
-    {
-        if (!line.empty())
-            array.emplace_back(line.begin(), line.end());
-    }
-    return array;
+    instrumentation::ScopedTimer parse_timer(parse_phase);
+    return GridFile(filename).to_grid();
 }
 
 /**
@@ -351,15 +789,15 @@ std::vector<std::vector<char>> ManagerClass::read_input(const std::string &filen
  * @return The GuardMovement representing the guard's start.
  * @throws std::invalid_argument if the guard is not found.
  */
-GuardMovement ManagerClass::find_guard_in_map(std::vector<std::vector<char>> map)
+GuardMovement ManagerClass::find_guard_in_map(const Grid<char> &map)
 {
-    for (size_t y = 0; y < map.size(); y++) // row (number of rows = y)
+    for (size_t y = 0; y < map.get_rows(); y++) // row (number of rows = y)
     {
-        for (size_t x = 0; x < map[0].size(); x++) // column (number of columns = x)
+        for (size_t x = 0; x < map.get_cols(); x++) // column (number of columns = x)
         {
-            if (std::string("^<>v").find(map[y][x]) != std::string::npos)
+            if (std::string("^<>v").find(map.at(y, x)) != std::string::npos)
             {
-                return GuardMovement(x, y, map[y][x]);
+                return GuardMovement(x, y, map.at(y, x));
             }
         }
     }
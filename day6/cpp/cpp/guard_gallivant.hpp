@@ -8,6 +8,11 @@
 #include <unordered_set>
 #include <map>
 #include <algorithm>
+#include <optional>
+#include <atomic>
+#include <cstdint>
+
+#include "grid.hpp"
 
 /**
  * @class GuardMovement
@@ -48,7 +53,7 @@ namespace std
     {
         std::size_t operator()(const GuardMovement &gm) const
         {
-            return std::hash<char>()(gm.direction) ^ std::hash<int>()(gm.x_position) ^ std::hash<int>()(gm.y_position);
+            return std::hash<uint64_t>()(pack_position(gm.x_position, gm.y_position)) * 131 + static_cast<unsigned char>(gm.direction);
         }
     };
 
@@ -57,7 +62,7 @@ namespace std
     {
         std::size_t operator()(const Position &p) const
         {
-            return std::hash<int>()(p.x_position) ^ std::hash<int>()(p.y_position);
+            return std::hash<uint64_t>()(pack_position(p.x_position, p.y_position));
         }
     };
 }
@@ -72,6 +77,25 @@ public:
     char *what();
 };
 
+/**
+ * @class ObstacleJumpTable
+ * @brief Next-obstacle index for every position and direction of a map.
+ *
+ * Built once from the starting map, it stores for each position and direction the last free
+ * coordinate along that row or column before the next obstacle, or -1 if the guard would leave the map.
+ * A single extra obstruction can be patched in at lookup time without rebuilding the table.
+ */
+class ObstacleJumpTable
+{
+public:
+    ObstacleJumpTable(const Grid<char> &map);
+    std::optional<Position> find_stop_position(const GuardMovement &current, const std::optional<Position> &extra_obstruction = std::nullopt) const;
+
+private:
+    size_t width, height;
+    std::vector<int> stops;
+};
+
 /**
  * @class GuardBehaviour
  * @brief Handles guard movement logic and obstacle encounters.
@@ -79,12 +103,40 @@ public:
 class GuardBehaviour
 {
 public:
-    static GuardMovement patrol_area(const GuardMovement &current, const std::vector<std::vector<char>> &map);
+    static GuardMovement patrol_area(const GuardMovement &current, const Grid<char> &map, const std::optional<Position> &extra_obstruction = std::nullopt);
+    static std::optional<GuardMovement> try_patrol_area(const GuardMovement &current, const Grid<char> &map, const std::optional<Position> &extra_obstruction = std::nullopt);
+    static std::optional<GuardMovement> jump_to_next_obstacle(const GuardMovement &current, const ObstacleJumpTable &jump_table, const std::optional<Position> &extra_obstruction = std::nullopt);
+    static size_t direction_index(char direction);
 
 private:
     static const std::map<char, std::pair<int, int>> &direction_map();
     static char handle_obstacle_encounter(const char &direction);
-    static bool guard_is_out_of_bounds(const int &new_x, const int &new_y, const std::vector<std::vector<char>> &map);
+    static bool guard_is_out_of_bounds(const int &new_x, const int &new_y, const Grid<char> &map);
+};
+
+/**
+ * @class VisitedStateGrid
+ * @brief Dense store of the positions and guard movements visited on a map.
+ *
+ * Keeps one stamp per position and one per position and direction (width * height * 4).
+ * An entry counts as visited when its stamp equals the current generation,
+ * so reset() is a single increment instead of clearing the whole grid.
+ */
+class VisitedStateGrid
+{
+public:
+    VisitedStateGrid(size_t width, size_t height);
+    void reset();
+    bool visit(const GuardMovement &gm);
+    void visit_position(int x, int y);
+    bool contains_position(int x, int y) const;
+    std::unordered_set<Position> get_visited_positions() const;
+
+private:
+    size_t width, height;
+    uint32_t generation;
+    std::vector<uint32_t> movement_stamps;
+    std::vector<uint32_t> position_stamps;
 };
 
 /**
@@ -94,35 +146,69 @@ private:
 class GuardSimulation
 {
 public:
-    GuardSimulation(std::vector<std::vector<char>> starting_map, GuardMovement initial_guard_movement);
+    GuardSimulation(const Grid<char> &starting_map, GuardMovement initial_guard_movement, const ObstacleJumpTable *jump_table = nullptr);
     std::unordered_set<Position> get_patrolled_area();
+    std::vector<GuardMovement> get_patrol_trajectory();
     bool results_in_loop();
+    bool results_in_loop_with_obstruction(const Position &obstruction);
+    bool results_in_loop_with_obstruction(const Position &obstruction, const GuardMovement &resume_guard_movement);
 
 private:
-    std::vector<std::vector<char>> map;
-    std::unordered_set<GuardMovement> visited_positions_with_direction;
-    std::unordered_set<Position> visited_positions;
+    const Grid<char> &map;
+    const ObstacleJumpTable *jump_table;
+    std::optional<Position> extra_obstruction;
+    VisitedStateGrid visited_states;
+    std::vector<GuardMovement> patrol_trajectory;
     GuardMovement initial_guard_movement;
-    bool guard_patrols_area_and_leaves_map();
+    bool guard_patrols_area_and_leaves_map(const GuardMovement &start_guard_movement, bool record_patrolled_area);
+    bool guard_jumps_between_obstacles_and_leaves_map(const GuardMovement &start_guard_movement);
+    bool results_in_loop_from(const GuardMovement &start_guard_movement);
     void print_patrolled_area(GuardMovement current_guard_movement);
 };
 
+/**
+ * @class ObstructionCandidate
+ * @brief A position to obstruct, together with the guard's state just before it first enters that position.
+ *
+ * The guard's patrol is unchanged until it reaches the obstruction, so a simulation can resume from that state.
+ */
+class ObstructionCandidate
+{
+public:
+    Position position;
+    GuardMovement resume_guard_movement;
+    ObstructionCandidate(const Position &position, const GuardMovement &resume_guard_movement);
+};
+
 /**
  * @class ManagerClass
  * @brief Manages file I/O, simulation setup, and analysis of obstructions.
+ *
+ * The map is read once and every query is answered from it. The guard's original patrol, which both parts
+ * start from, and the loop positions are computed on first use and cached, so queries can be repeated cheaply.
+ * Queries are not safe to run concurrently on the same ManagerClass.
+ * @param input_file_name The path to the input file.
+ * @param number_of_threads Number of worker threads used for the obstruction search (0 = hardware concurrency).
  */
 class ManagerClass
 {
 public:
-    ManagerClass(const std::string &input_file_name);
+    ManagerClass(const std::string &input_file_name, size_t number_of_threads = 1);
     std::unordered_set<Position> get_all_possible_obstructions_to_create_guard_loops();
     size_t get_number_of_obstructions_for_guard_loops();
     std::unordered_set<Position> get_patrolled_area();
     size_t get_number_of_patrolled_positions();
 
 private:
-    std::vector<std::vector<char>> starting_map;
+    Grid<char> starting_map;
     GuardMovement initial_guard_movement;
-    std::vector<std::vector<char>> read_input(const std::string &filename);
-    GuardMovement find_guard_in_map(std::vector<std::vector<char>> map);
+    ObstacleJumpTable jump_table;
+    size_t number_of_threads;
+    std::optional<std::vector<ObstructionCandidate>> obstruction_candidates;
+    std::optional<std::unordered_set<Position>> guard_loop_positions;
+    const std::vector<ObstructionCandidate> &get_obstruction_candidates();
+    std::vector<ObstructionCandidate> find_obstruction_candidates();
+    std::vector<Position> search_obstruction_candidates(const std::vector<ObstructionCandidate> &candidates, std::atomic<size_t> &next_candidate);
+    Grid<char> read_input(const std::string &filename);
+    GuardMovement find_guard_in_map(const Grid<char> &map);
 };
\ No newline at end of file
@@ -1,26 +1,60 @@
 #include "guard_gallivant.hpp"
+#include "batch.hpp"
+#include "instrumentation.hpp"
+#include <charconv>
+#include <string_view>
+#include <thread>
 
 /**
  * @brief Entry point. Runs the simulation and prints the results for part one and part two.
+ *
+ * Usage: guard_gallivant [input_file [number_of_threads]]
+ *        guard_gallivant --batch [--format=csv|json] [--workers=<n>] [--list=<file>] [<file or directory>...]
+ * A thread count of 0 uses all available hardware threads, a thread count that is not a number exits with code 2.
+ * The batch mode solves every input on a pool of workers, each searching its obstructions on a single thread, and streams
+ * one result per input to stdout, see batch.hpp.
+ * Built with INSTRUMENTATION=1, the counters and phase timings are written to stderr as JSON.
  */
 int main(int argc, char *argv[])
 {
+    if (argc > 1 && std::string(argv[1]) == "--batch")
+    {
+        return batch::run_from_command_line(std::vector<std::string>(argv + 2, argv + argc), [](const std::string &filename)
+                                            {
+                                                ManagerClass manager(filename, 1);
+                                                return batch::Answers{manager.get_number_of_patrolled_positions(), manager.get_number_of_obstructions_for_guard_loops()}; });
+    }
+
     std::cout << "Guard Gallivant Simulation\n";
     std::cout << "==========================\n";
     std::string filename;
-    if (argc > 2)
+    size_t number_of_threads = 0;
+    if (argc > 1)
     {
         std::cout << "Filename provided: " << argv[1] << " \n";
         filename = argv[1];
+        if (argc > 2)
+        {
+            std::string_view argument = argv[2];
+            auto [end, error] = std::from_chars(argument.data(), argument.data() + argument.size(), number_of_threads);
+            if (error != std::errc() || end != argument.data() + argument.size())
+            {
+                std::cerr << "Error: The number of threads " << argument << " needs to be a non-negative integer." << std::endl;
+                return 2;
+            }
+        }
     }
-    else if (argc < 2)
+    else
     {
         // filename = "../puzzle_input";
         filename = "../small_puzzle_input";
         std::cout << "No input file provided. Using default filename " << filename << "\n";
     }
 
-    std::cout << "Part One: " << ManagerClass(filename).get_number_of_patrolled_positions() << "\n";
+    ManagerClass manager(filename, number_of_threads);
+    std::cout << "Part One: " << manager.get_number_of_patrolled_positions() << "\n";
+
+    std::cout << "Part Two: " << manager.get_number_of_obstructions_for_guard_loops() << "\n";
 
-    std::cout << "Part Two: " << ManagerClass(filename).get_number_of_obstructions_for_guard_loops() << "\n";
-}
\ No newline at end of file
+    instrumentation::write_json(std::cerr);
+}
@@ -22,10 +22,10 @@ TEST(GuardMovementTest, EqualityAndStream)
 
 TEST(GuardBehaviourTest, PatrolAreaMovesCorrectly)
 {
-    std::vector<std::vector<char>> map = {
+    Grid<char> map(std::vector<std::vector<char>>{
         {'.', '.', '.'},
         {'.', '^', '.'},
-        {'.', '.', '.'}};
+        {'.', '.', '.'}});
     GuardMovement start(1, 1, '^');
     GuardMovement next = GuardBehaviour::patrol_area(start, map);
     EXPECT_EQ(next.x_position, 1);
@@ -35,10 +35,10 @@ TEST(GuardBehaviourTest, PatrolAreaMovesCorrectly)
 
 TEST(GuardBehaviourTest, PatrolAreaTurnsOnObstacle)
 {
-    std::vector<std::vector<char>> map = {
+    Grid<char> map(std::vector<std::vector<char>>{
         {'.', '#', '.'},
         {'.', '^', '.'},
-        {'.', '.', '.'}};
+        {'.', '.', '.'}});
     GuardMovement start(1, 1, '^');
     GuardMovement next = GuardBehaviour::patrol_area(start, map);
     EXPECT_EQ(next.x_position, 1);
@@ -46,9 +46,134 @@ TEST(GuardBehaviourTest, PatrolAreaTurnsOnObstacle)
     EXPECT_EQ(next.direction, '>');
 }
 
+TEST(VisitedStateGridTest, VisitAndReset)
+{
+    VisitedStateGrid grid(3, 2);
+    EXPECT_TRUE(grid.visit(GuardMovement(2, 1, '^')));
+    EXPECT_FALSE(grid.visit(GuardMovement(2, 1, '^')));
+    EXPECT_TRUE(grid.visit(GuardMovement(2, 1, '>')));
+    grid.visit_position(2, 1);
+    EXPECT_TRUE(grid.contains_position(2, 1));
+    EXPECT_EQ(grid.get_visited_positions(), std::unordered_set<Position>({Position(2, 1)}));
+
+    grid.reset();
+    EXPECT_FALSE(grid.contains_position(2, 1));
+    EXPECT_TRUE(grid.get_visited_positions().empty());
+    EXPECT_TRUE(grid.visit(GuardMovement(2, 1, '^')));
+}
+
+TEST(GuardSimulationTest, PatrolsNonSquareMap)
+{
+    Grid<char> map(std::vector<std::vector<char>>{
+        {'.', '#', '.', '.', '.'},
+        {'.', '^', '.', '.', '.'}});
+    GuardMovement start(1, 1, '^');
+    GuardSimulation sim(map, start);
+    // Turns right at the obstacle and walks along the bottom row, which is wider than the map is tall
+    EXPECT_EQ(sim.get_patrolled_area().size(), 4);
+}
+
+TEST(ObstacleJumpTableTest, FindsStopPositions)
+{
+    Grid<char> map(std::vector<std::vector<char>>{
+        {'.', '#', '.', '.'},
+        {'.', '.', '.', '#'},
+        {'.', '^', '.', '.'}});
+    ObstacleJumpTable table(map);
+    EXPECT_EQ(table.find_stop_position(GuardMovement(1, 2, '^')), Position(1, 1));
+    EXPECT_EQ(table.find_stop_position(GuardMovement(0, 1, '>')), Position(2, 1));
+    EXPECT_EQ(table.find_stop_position(GuardMovement(1, 2, '>')), std::nullopt);
+    EXPECT_EQ(table.find_stop_position(GuardMovement(1, 2, '>'), Position(3, 2)), Position(2, 2));
+    // An extra obstruction behind the regular obstacle does not change the stop position
+    EXPECT_EQ(table.find_stop_position(GuardMovement(0, 1, '>'), Position(3, 1)), Position(2, 1));
+    EXPECT_EQ(table.find_stop_position(GuardMovement(2, 1, '^'), Position(2, 0)), Position(2, 1));
+}
+
+TEST(GuardBehaviourTest, JumpToNextObstacleTurns)
+{
+    Grid<char> map(std::vector<std::vector<char>>{
+        {'.', '#', '.'},
+        {'.', '.', '.'},
+        {'.', '^', '.'}});
+    ObstacleJumpTable table(map);
+    auto next = GuardBehaviour::jump_to_next_obstacle(GuardMovement(1, 2, '^'), table);
+    ASSERT_TRUE(next.has_value());
+    EXPECT_EQ(*next, GuardMovement(1, 1, '>'));
+    EXPECT_FALSE(GuardBehaviour::jump_to_next_obstacle(*next, table).has_value());
+    EXPECT_FALSE(GuardBehaviour::try_patrol_area(GuardMovement(2, 1, '>'), map).has_value());
+}
+
+TEST(GuardSimulationTest, JumpingMatchesStepping)
+{
+    Grid<char> map(std::vector<std::vector<char>>{
+        {'.', '.', '.', '.', '#', '.', '.', '.', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', '.', '.', '.', '#'},
+        {'.', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
+        {'.', '.', '#', '.', '.', '.', '.', '.', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', '.', '#', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
+        {'.', '#', '.', '.', '^', '.', '.', '.', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', '.', '.', '#', '.'},
+        {'#', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', '#', '.', '.', '.'}});
+    GuardMovement start(4, 6, '^');
+    ObstacleJumpTable table(map);
+    GuardSimulation stepping(map, start);
+    GuardSimulation jumping(map, start, &table);
+    for (int y = 0; y < (int)map.get_rows(); y++)
+    {
+        for (int x = 0; x < (int)map.get_cols(); x++)
+        {
+            EXPECT_EQ(stepping.results_in_loop_with_obstruction(Position(x, y)), jumping.results_in_loop_with_obstruction(Position(x, y)))
+                << "Obstruction at " << x << ", " << y;
+        }
+    }
+}
+
+TEST(GuardSimulationTest, PatrolTrajectoryIsOrdered)
+{
+    Grid<char> map(std::vector<std::vector<char>>{
+        {'.', '#', '.'},
+        {'.', '.', '.'},
+        {'.', '^', '.'}});
+    GuardSimulation sim(map, GuardMovement(1, 2, '^'));
+    EXPECT_EQ(sim.get_patrol_trajectory(), std::vector<GuardMovement>({GuardMovement(1, 2, '^'),
+                                                                        GuardMovement(1, 1, '^'),
+                                                                        GuardMovement(1, 1, '>'),
+                                                                        GuardMovement(2, 1, '>')}));
+}
+
+TEST(GuardSimulationTest, ResumingFromFirstVisitMatchesFullPatrol)
+{
+    Grid<char> map(std::vector<std::vector<char>>{
+        {'.', '.', '.', '.', '#', '.', '.', '.', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', '.', '.', '.', '#'},
+        {'.', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
+        {'.', '.', '#', '.', '.', '.', '.', '.', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', '.', '#', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
+        {'.', '#', '.', '.', '^', '.', '.', '.', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', '.', '.', '#', '.'},
+        {'#', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', '#', '.', '.', '.'}});
+    GuardMovement start(4, 6, '^');
+    ObstacleJumpTable table(map);
+    GuardSimulation sim(map, start, &table);
+    auto trajectory = GuardSimulation(map, start).get_patrol_trajectory();
+    std::unordered_set<Position> seen = {Position(start.x_position, start.y_position)};
+    for (size_t idx = 1; idx < trajectory.size(); ++idx)
+    {
+        Position pos(trajectory[idx].x_position, trajectory[idx].y_position);
+        if (!seen.insert(pos).second)
+            continue;
+        EXPECT_EQ(sim.results_in_loop_with_obstruction(pos), sim.results_in_loop_with_obstruction(pos, trajectory[idx - 1]))
+            << "Obstruction at " << pos.x_position << ", " << pos.y_position;
+    }
+}
+
 TEST(GuardSimulationTest, DetectsLoop)
 {
-    std::vector<std::vector<char>> map_with_loop = {
+    Grid<char> map_with_loop(std::vector<std::vector<char>>{
         {'.', '.', '.', '.', '#', '.', '.', '.', '.', '.'},
         {'.', '.', '.', '.', '.', '.', '.', '.', '.', '#'},
         {'.', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
@@ -58,7 +183,7 @@ TEST(GuardSimulationTest, DetectsLoop)
         {'.', '#', '.', '#', '^', '.', '.', '.', '.', '.'},
         {'.', '.', '.', '.', '.', '.', '.', '.', '#', '.'},
         {'#', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
-        {'.', '.', '.', '.', '.', '.', '#', '.', '.', '.'}};
+        {'.', '.', '.', '.', '.', '.', '#', '.', '.', '.'}});
     GuardMovement start(4, 6, '^');
     GuardSimulation sim(map_with_loop, start);
     EXPECT_TRUE(sim.results_in_loop());
@@ -66,15 +191,36 @@ TEST(GuardSimulationTest, DetectsLoop)
 
 TEST(GuardSimulationTest, DetectsExit)
 {
-    std::vector<std::vector<char>> map = {
+    Grid<char> map(std::vector<std::vector<char>>{
         {'.', '.', '.'},
         {'.', '^', '.'},
-        {'.', '.', '.'}};
+        {'.', '.', '.'}});
     GuardMovement start(1, 1, '^');
     GuardSimulation sim(map, start);
     EXPECT_FALSE(sim.results_in_loop());
 }
 
+TEST(GuardSimulationTest, DetectsLoopWithExtraObstruction)
+{
+    Grid<char> map(std::vector<std::vector<char>>{
+        {'.', '.', '.', '.', '#', '.', '.', '.', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', '.', '.', '.', '#'},
+        {'.', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
+        {'.', '.', '#', '.', '.', '.', '.', '.', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', '.', '#', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
+        {'.', '#', '.', '.', '^', '.', '.', '.', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', '.', '.', '#', '.'},
+        {'#', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', '#', '.', '.', '.'}});
+    GuardMovement start(4, 6, '^');
+    GuardSimulation sim(map, start);
+    EXPECT_FALSE(sim.results_in_loop());
+    EXPECT_TRUE(sim.results_in_loop_with_obstruction(Position(3, 6)));
+    EXPECT_FALSE(sim.results_in_loop_with_obstruction(Position(0, 0)));
+    EXPECT_EQ(map.at(6, 3), '.'); // The shared map is never modified
+}
+
 TEST(ManagerClassTest, ThrowsIfFileDoesNotExist)
 {
     EXPECT_THROW(ManagerClass("nonexistent_file.txt"), std::runtime_error);
@@ -87,15 +233,38 @@ TEST(ManagerClassTest, ThrowsIfNoGuardInMap)
 
 TEST(ManagerClassTest, PatrolledAreaCount)
 {
-    std::vector<std::vector<char>> map = {
+    Grid<char> map(std::vector<std::vector<char>>{
         {'.', '.', '.'},
         {'.', '^', '.'},
-        {'.', '.', '.'}};
+        {'.', '.', '.'}});
     GuardMovement start(1, 1, '^');
     GuardSimulation sim(map, start);
     EXPECT_EQ(sim.get_patrolled_area().size(), 2); // Should visit 2 unique positions
 }
 
+TEST(ManagerClassTest, ObstructionsForGuardLoops)
+{
+    EXPECT_EQ(ManagerClass("../small_puzzle_input").get_number_of_obstructions_for_guard_loops(), 6);
+}
+
+TEST(ManagerClassTest, SessionAnswersRepeatedQueries)
+{
+    ManagerClass manager("../small_puzzle_input");
+    EXPECT_EQ(manager.get_number_of_patrolled_positions(), 41);
+    EXPECT_EQ(manager.get_number_of_obstructions_for_guard_loops(), 6);
+    EXPECT_EQ(manager.get_patrolled_area().size(), 41);
+    EXPECT_EQ(manager.get_all_possible_obstructions_to_create_guard_loops(),
+              ManagerClass("../small_puzzle_input").get_all_possible_obstructions_to_create_guard_loops());
+    EXPECT_EQ(manager.get_number_of_obstructions_for_guard_loops(), 6);
+}
+
+TEST(ManagerClassTest, ParallelObstructionSearchMatchesSerial)
+{
+    auto serial = ManagerClass("../small_puzzle_input", 1).get_all_possible_obstructions_to_create_guard_loops();
+    auto parallel = ManagerClass("../small_puzzle_input", 4).get_all_possible_obstructions_to_create_guard_loops();
+    EXPECT_EQ(serial, parallel);
+}
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,58 @@
+#include "bench.hpp"
+#include "grid_file.hpp"
+#include "resonant_collinearity.hpp"
+
+/**
+ * @brief Generates an antenna map with about 2 % antennas spread over 36 frequencies.
+ * @param size The number of rows and columns.
+ */
+std::string generate_antenna_map(bench::Generator &generator, size_t size)
+{
+    const std::string frequencies = "0123456789abcdefghijklmnopqrstuvwxyz";
+    return generator.grid(size, size, [&frequencies](bench::Generator &g, size_t, size_t, const std::string &)
+                          { return g.chance(0.02) ? frequencies[g.uniform(0, frequencies.size() - 1)] : '.'; });
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        bench::Suite suite("Resonant Collinearity", argc, argv);
+        bench::Generator generator;
+        const std::vector<std::pair<AntinodeEngine, std::string>> engines{
+            {AntinodeEngine::POSITION_SETS, "POSITION_SETS"}, {AntinodeEngine::DENSE_BITMAP, "DENSE_BITMAP"}, {AntinodeEngine::HARMONIC_LINES, "HARMONIC_LINES"}};
+        for (size_t size : {50 * suite.get_scale(), 200 * suite.get_scale()})
+        {
+            std::string label = std::to_string(size) + "x" + std::to_string(size);
+            std::string filename = bench::write_input("build/bench_antenna_map_" + label, generate_antenna_map(generator, size));
+
+            suite.run("parse@" + label, [&]
+                      { return ManagerClass(filename).get_number_of_unique_antinode_positions(); });
+            Grid<char> grid = GridFile(filename).to_grid();
+            for (const auto &[engine, engine_name] : engines)
+            {
+                suite.run("antinodes@" + label + "/" + engine_name, [&]
+                          { return ResonantCollinearity(grid, false, engine).get_number_of_unique_antinode_positions(); });
+            }
+            for (const auto &[engine, engine_name] : engines)
+            {
+                suite.run("resonant_harmonics@" + label + "/" + engine_name, [&]
+                          { return ResonantCollinearity(grid, true, engine).get_unique_antinode_positions().size(); });
+            }
+            suite.run("both_parts@" + label + "/MANAGER_PER_PART", [&]
+                      { return ManagerClass(filename).get_number_of_unique_antinode_positions() +
+                               ManagerClass(filename).get_number_of_unique_antinode_positions_with_resonant_harmonics(); });
+            suite.run("both_parts@" + label + "/SESSION", [&]
+                      {
+                          ManagerClass manager(filename);
+                          return manager.get_number_of_unique_antinode_positions() +
+                                 manager.get_number_of_unique_antinode_positions_with_resonant_harmonics(); });
+        }
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,19 +1,34 @@
 #include "resonant_collinearity.hpp"
+#include "batch.hpp"
+#include "instrumentation.hpp"
 
 /**
  * @brief Entry point. Runs the simulation and prints the results for part one and part two.
+ *
+ * Usage: resonant_collinearity [input_file]
+ *        resonant_collinearity --batch [--format=csv|json] [--workers=<n>] [--list=<file>] [<file or directory>...]
+ * The batch mode solves every input on a pool of workers and streams one result per input to stdout, see batch.hpp.
+ * Built with INSTRUMENTATION=1, the counters and phase timings are written to stderr as JSON.
  */
 int main(int argc, char *argv[])
 {
+    if (argc > 1 && std::string(argv[1]) == "--batch")
+    {
+        return batch::run_from_command_line(std::vector<std::string>(argv + 2, argv + argc), [](const std::string &filename)
+                                            {
+                                                ManagerClass manager(filename);
+                                                return batch::Answers{manager.get_number_of_unique_antinode_positions(), manager.get_number_of_unique_antinode_positions_with_resonant_harmonics()}; });
+    }
+
     std::cout << "Resonant Collinearity Simulation\n";
     std::cout << "==========================\n";
     std::string filename;
-    if (argc > 2)
+    if (argc > 1)
     {
         std::cout << "Filename provided: " << argv[1] << " \n";
         filename = argv[1];
     }
-    else if (argc < 2)
+    else
     {
         //filename = "../puzzle_input";
         filename = "../small_puzzle_input";
@@ -21,9 +36,10 @@ int main(int argc, char *argv[])
         std::cout << "No input file provided. Using default filename " << filename << "\n";
     }
 
-    auto unique_antinode_positions = ManagerClass(filename).get_unique_antinode_positions();
-    std::cout << "Part One: " << unique_antinode_positions.size() << "\n";
+    ManagerClass manager(filename);
+    std::cout << "Part One: " << manager.get_number_of_unique_antinode_positions() << "\n";
+
+    std::cout << "Part Two: " << manager.get_number_of_unique_antinode_positions_with_resonant_harmonics() << "\n";
 
-    auto unique_antinode_positions_with_resonant_harmonics = ManagerClass(filename).get_unique_antinode_positions_with_resonant_harmonics();
-    std::cout << "Part Two: " << unique_antinode_positions_with_resonant_harmonics.size() << "\n";
-}
\ No newline at end of file
+    instrumentation::write_json(std::cerr);
+}
@@ -2,6 +2,22 @@
 
 #include "resonant_collinearity.hpp"
 
+#include <bit>
+#include <climits>
+#include <numeric>
+#include <optional>
+
+#include "grid_file.hpp"
+#include "instrumentation.hpp"
+
+static instrumentation::Counter frequencies_found("frequencies_found");
+static instrumentation::Counter antennas_found("antennas_found");
+static instrumentation::Counter antenna_pairs_visited("antenna_pairs_visited");
+static instrumentation::Counter harmonic_lines_walked("harmonic_lines_walked");
+static instrumentation::Phase parse_phase("parse");
+static instrumentation::Phase compute_phase("compute");
+static instrumentation::Phase reduce_phase("reduce");
+
 /**
  * @brief Constructs a Position object.
  * @param x The x (#columns) position.
@@ -20,84 +36,225 @@ bool Position::operator==(const Position &other) const
     return x_position == other.x_position && y_position == other.y_position;
 }
 
+/**
+ * @brief Constructs the HarmonicLine through two different positions.
+ * @param pos The first position on the line.
+ * @param compare_pos The second position on the line.
+ */
+HarmonicLine::HarmonicLine(const Position &pos, const Position &compare_pos)
+{
+    dx = compare_pos.x_position - pos.x_position;
+    dy = compare_pos.y_position - pos.y_position;
+    int divisor = std::gcd(dx, dy);
+    dx /= divisor;
+    dy /= divisor;
+    if (dx < 0 || (dx == 0 && dy < 0))
+    {
+        dx = -dx;
+        dy = -dy;
+    }
+    // The cross product with the direction is the same for every position on the line.
+    offset = (long long)dx * pos.y_position - (long long)dy * pos.x_position;
+}
+
+/**
+ * @brief Equality operator for HarmonicLine.
+ * @param other The other HarmonicLine to compare.
+ * @return True if both describe the same line.
+ */
+bool HarmonicLine::operator==(const HarmonicLine &other) const
+{
+    return dx == other.dx && dy == other.dy && offset == other.offset;
+}
+
+/**
+ * @brief Constructs an AntinodeBitmap with no antinode marked.
+ * @param rows The number of rows of the grid.
+ * @param cols The number of columns of the grid.
+ */
+AntinodeBitmap::AntinodeBitmap(size_t rows, size_t cols)
+    : rows(rows), cols(cols), words((rows * cols + 63) / 64, 0) {}
+
+/**
+ * @brief Marks a cell as holding an antinode.
+ * @param x The x (#columns) position, inside the grid.
+ * @param y The y (#rows) position, inside the grid.
+ */
+void AntinodeBitmap::mark(int x, int y)
+{
+    size_t bit = (size_t)y * cols + x;
+    words[bit / 64] |= uint64_t{1} << (bit % 64);
+}
+
+/**
+ * @brief Checks whether a cell holds an antinode.
+ * @param x The x (#columns) position, inside the grid.
+ * @param y The y (#rows) position, inside the grid.
+ * @return True if the cell is marked.
+ */
+bool AntinodeBitmap::contains(int x, int y) const
+{
+    size_t bit = (size_t)y * cols + x;
+    return (words[bit / 64] >> (bit % 64)) & 1;
+}
+
+/**
+ * @brief Returns the number of cells holding an antinode.
+ * @return The number of marked cells.
+ */
+size_t AntinodeBitmap::count() const
+{
+    size_t marked = 0;
+    for (uint64_t word : words)
+    {
+        marked += std::popcount(word);
+    }
+    return marked;
+}
+
+/**
+ * @brief Adds the antinodes marked in another bitmap of the same grid.
+ * @param other The other bitmap.
+ * @return This bitmap.
+ * @throws std::invalid_argument if the bitmaps cover grids of a different size.
+ */
+AntinodeBitmap &AntinodeBitmap::operator|=(const AntinodeBitmap &other)
+{
+    if (rows != other.rows || cols != other.cols)
+        throw std::invalid_argument("Error: Only bitmaps of the same grid can be combined.");
+
+    for (size_t word = 0; word < words.size(); ++word)
+    {
+        words[word] |= other.words[word];
+    }
+    return *this;
+}
+
+/**
+ * @brief Returns the positions of all cells holding an antinode.
+ * @return An unordered_set of Position objects.
+ */
+std::unordered_set<Position> AntinodeBitmap::get_positions() const
+{
+    std::unordered_set<Position> positions;
+    positions.reserve(count());
+    for (size_t word = 0; word < words.size(); ++word)
+    {
+        for (uint64_t bits = words[word]; bits != 0; bits &= bits - 1)
+        {
+            size_t bit = word * 64 + std::countr_zero(bits);
+            positions.insert(Position(bit % cols, bit / cols));
+        }
+    }
+    return positions;
+}
+
 /**
  * @brief Constructs a ManagerClass and reads the grid from file.
  * @param filename The path to the input file.
+ * @param number_of_threads Number of worker threads marking the antinodes of the frequencies (0 = hardware concurrency).
  */
-ManagerClass::ManagerClass(const std::string &filename)
+ManagerClass::ManagerClass(const std::string &filename, size_t number_of_threads)
+    : number_of_threads(number_of_threads)
 {
     grid = read_input(filename);
 }
 
 /**
  * @brief Returns a set of unique antinode positions in the grid.
+ * @param antinode_engine The algorithm used for collecting the antinode positions.
  * @return An unordered_set of Position objects.
  */
-std::unordered_set<Position> ManagerClass::get_unique_antinode_positions()
+std::unordered_set<Position> ManagerClass::get_unique_antinode_positions(AntinodeEngine antinode_engine)
 {
-    ResonantCollinearity resonant_collinearity(grid);
-    return resonant_collinearity.get_unique_antinode_positions();
+    return get_antinodes(false, antinode_engine).get_unique_antinode_positions();
 }
 
 /**
  * @brief Returns a set of unique antinode positions in the grid where resonant harmonics have been taken into account.
+ * @param antinode_engine The algorithm used for collecting the antinode positions.
  * @return An unordered_set of Position objects.
  */
-std::unordered_set<Position> ManagerClass::get_unique_antinode_positions_with_resonant_harmonics()
+std::unordered_set<Position> ManagerClass::get_unique_antinode_positions_with_resonant_harmonics(AntinodeEngine antinode_engine)
 {
-    ResonantCollinearity resonant_collinearity(grid, true);
-    return resonant_collinearity.get_unique_antinode_positions();
+    return get_antinodes(true, antinode_engine).get_unique_antinode_positions();
 }
 
 /**
  * @brief Returns the number of unique antinode positions in the grid.
+ * @param antinode_engine The algorithm used for collecting the antinode positions.
  * @return The number of unique antinode positions.
  */
-size_t ManagerClass::get_number_of_unique_antinode_positions()
+size_t ManagerClass::get_number_of_unique_antinode_positions(AntinodeEngine antinode_engine)
+{
+    return get_antinodes(false, antinode_engine).get_number_of_unique_antinode_positions();
+}
+
+/**
+ * @brief Returns the number of unique antinode positions in the grid where resonant harmonics have been taken into account.
+ * @param antinode_engine The algorithm used for collecting the antinode positions.
+ * @return The number of unique antinode positions.
+ */
+size_t ManagerClass::get_number_of_unique_antinode_positions_with_resonant_harmonics(AntinodeEngine antinode_engine)
+{
+    return get_antinodes(true, antinode_engine).get_number_of_unique_antinode_positions();
+}
+
+/**
+ * @brief Returns the antinodes of all frequencies, marking them on the first call for each combination of arguments.
+ *
+ * The antennas are sorted into their frequencies once, on the first call, and shared by all combinations.
+ * @param resonant_harmonics Whether to consider resonant harmonics.
+ * @param antinode_engine The algorithm used for collecting the antinode positions.
+ * @return The ResonantCollinearity holding the antinodes.
+ */
+const ResonantCollinearity &ManagerClass::get_antinodes(bool resonant_harmonics, AntinodeEngine antinode_engine)
 {
-    ResonantCollinearity resonant_collinearity(grid);
-    return resonant_collinearity.get_number_of_unique_antinode_positions();
+    auto cached = antinodes.find({resonant_harmonics, antinode_engine});
+    if (cached != antinodes.end())
+        return cached->second;
+
+    if (!frequencies)
+        frequencies = ResonantCollinearity::find_frequencies(grid);
+    return antinodes.try_emplace({resonant_harmonics, antinode_engine}, grid, *frequencies, resonant_harmonics, antinode_engine, number_of_threads).first->second;
 }
 
 /**
  * @brief Reads the content of the input file.
  * @param filename The path to the input file.
- * @return A 2D vector of characters representing the grid.
+ * @return A grid of characters.
  * @throws std::runtime_error if the file does not exist or is empty.
+ * @throws std::invalid_argument if the lines of the file differ in length.
  */
-std::vector<std::vector<char>> ManagerClass::read_input(const std::string &filename)
+Grid<char> ManagerClass::read_input(const std::string &filename)
 {
-    std::vector<std::vector<char>> array;
-    std::ifstream infile(filename);
-    if (!infile)
-    {
-        throw std::runtime_error("Error: The file " + filename + " does not exist.");
-    }
-    std::string line;
-    while (std::getline(infile, line))
-    {
-        if (!line.empty())
-            array.emplace_back(line.begin(), line.end());
-    }
-    if (array.empty())
-    {
-        throw std::runtime_error("Error: The file " + filename + " is empty or invalid.");
-    }
-    return array;
+    instrumentation::ScopedTimer parse_timer(parse_phase);
+    return GridFile(filename).to_grid();
 }
 
 /**
  * @brief Constructs a ResonantCollinearity object and processes frequencies in the grid.
  * @param grid The 2D grid of characters.
  * @param resonant_harmonics Whether to consider resonant harmonics.
+ * @param antinode_engine The algorithm used for collecting the antinode positions.
+ * @param number_of_threads Number of worker threads marking the antinodes of the frequencies (0 = hardware concurrency).
  */
-ResonantCollinearity::ResonantCollinearity(const std::vector<std::vector<char>> &grid, bool resonant_harmonics)
-{
-    std::cout << "Processing grid of size: " << grid.size() << "x" << grid[0].size() << std::endl;
-    // Initialize the ResonantCollinearity with the provided grid
-    this->unique_antinode_positions.clear();
-    this->frequencies.clear();
+ResonantCollinearity::ResonantCollinearity(const Grid<char> &grid, bool resonant_harmonics, AntinodeEngine antinode_engine, size_t number_of_threads)
+    : ResonantCollinearity(grid, find_frequencies(grid), resonant_harmonics, antinode_engine, number_of_threads) {}
 
+/**
+ * @brief Constructs a ResonantCollinearity object from frequencies sorted by an earlier scan of the grid.
+ * @param grid The 2D grid of characters.
+ * @param frequencies The frequencies of the grid, as returned by find_frequencies.
+ * @param resonant_harmonics Whether to consider resonant harmonics.
+ * @param antinode_engine The algorithm used for collecting the antinode positions.
+ * @param number_of_threads Number of worker threads marking the antinodes of the frequencies (0 = hardware concurrency).
+ */
+ResonantCollinearity::ResonantCollinearity(const Grid<char> &grid, std::vector<Frequency> frequencies, bool resonant_harmonics, AntinodeEngine antinode_engine, size_t number_of_threads)
+    : antinode_engine(antinode_engine),
+      number_of_threads(number_of_threads != 0 ? number_of_threads : std::max(1u, std::thread::hardware_concurrency())),
+      frequencies(std::move(frequencies))
+{
     process_frequencies(grid, resonant_harmonics);
 }
 
@@ -106,63 +263,113 @@ ResonantCollinearity::ResonantCollinearity(const std::vector<std::vector<char>>
  * @param grid The 2D grid of characters.
  * @param resonant_harmonics Whether to consider resonant harmonics.
  */
-void ResonantCollinearity::process_frequencies(const std::vector<std::vector<char>> &grid, bool resonant_harmonics)
+void ResonantCollinearity::process_frequencies(const Grid<char> &grid, bool resonant_harmonics)
 {
-    std::unordered_set<char> unique_frequencies;
-    // Process the grid to find unique frequencies and their antinode positions
-    for (const auto &row : grid)
+    std::optional<instrumentation::ScopedTimer> compute_timer(compute_phase);
+
+    // Collect all unique antinode positions from all frequencies
+    if (antinode_engine != AntinodeEngine::POSITION_SETS)
     {
-        for (char cell : row)
+        std::atomic<size_t> next_frequency{0};
+        size_t workers = std::min(number_of_threads, frequencies.size());
+        if (workers <= 1)
         {
-            if (cell != '.' && cell != '#')
+            antinode_bitmap = mark_frequencies(grid, resonant_harmonics, next_frequency);
+        }
+        else
+        {
+            std::vector<AntinodeBitmap> bitmap_per_worker(workers);
+            std::vector<std::thread> threads;
+            threads.reserve(workers);
+            for (size_t worker = 0; worker < workers; ++worker)
+            {
+                threads.emplace_back([&, worker]()
+                                     { bitmap_per_worker[worker] = mark_frequencies(grid, resonant_harmonics, next_frequency); });
+            }
+            for (auto &thread : threads)
+            {
+                thread.join();
+            }
+            compute_timer.reset();
+
+            instrumentation::ScopedTimer reduce_timer(reduce_phase);
+            antinode_bitmap = std::move(bitmap_per_worker[0]);
+            for (size_t worker = 1; worker < workers; ++worker)
             {
-                unique_frequencies.insert(cell);
+                antinode_bitmap |= bitmap_per_worker[worker];
             }
         }
     }
-
-    // Create Frequency objects for each unique frequency
-    for (char frequency_char : unique_frequencies)
+    else
     {
-        frequencies.emplace(Frequency(frequency_char, grid));
+        for (const auto &frequency : frequencies)
+        {
+            /*  if (resonant_harmonics)
+                 auto antinode_positions = frequency.get_unique_antinode_positions_with_resonant_harmonics(grid);
+             else */
+            auto antinode_positions = frequency.get_antinode_positions(grid, resonant_harmonics);
+            instrumentation::ScopedTimer reduce_timer(reduce_phase);
+            unique_antinode_positions.insert(antinode_positions.begin(), antinode_positions.end());
+        }
     }
-    //std::cout << "Found " << frequencies.size() << " unique frequencies in the grid." << std::endl;
+}
 
-    // Collect all unique antinode positions from all frequencies
-    std::unordered_set<Position> antinode_positions;
-    for (const auto &frequency : frequencies)
+/**
+ * @brief Sorts the antennas of the grid into their frequencies in a single scan of the grid.
+ * @param grid The 2D grid of characters.
+ * @return The frequencies that have at least one antenna, ordered by their character.
+ */
+std::vector<Frequency> ResonantCollinearity::find_frequencies(const Grid<char> &grid)
+{
+    instrumentation::ScopedTimer compute_timer(compute_phase);
+    std::vector<Frequency> frequencies;
+    std::array<std::vector<Position>, 256> positions_per_frequency;
+    grid.for_each_index([&](size_t index)
+                        {
+        char cell = grid[index];
+        if (cell != '.' && cell != '#')
+            positions_per_frequency[(unsigned char)cell].push_back(Position(grid.get_col(index), grid.get_row(index))); });
+
+    for (size_t frequency_char = 0; frequency_char < positions_per_frequency.size(); ++frequency_char)
     {
-        /*  if (resonant_harmonics)
-             auto antinode_positions = frequency.get_unique_antinode_positions_with_resonant_harmonics(grid);
-         else */
-        auto antinode_positions = frequency.get_antinode_positions(grid, resonant_harmonics);
-        unique_antinode_positions.insert(antinode_positions.begin(), antinode_positions.end());
+        if (positions_per_frequency[frequency_char].empty())
+            continue;
+        antennas_found.add(positions_per_frequency[frequency_char].size());
+        frequencies.emplace_back(Frequency((char)frequency_char, std::move(positions_per_frequency[frequency_char])));
     }
+    frequencies_found.add(frequencies.size());
+    return frequencies;
+}
 
-    // Debug output for antinode positions
-    for (int i = 0; i < (int)grid.size(); ++i)
+/**
+ * @brief Worker loop that claims frequencies one at a time and marks their antinodes until none are left.
+ * @param grid The 2D grid of characters.
+ * @param resonant_harmonics Whether to consider resonant harmonics.
+ * @param next_frequency Shared index of the next unclaimed frequency.
+ * @return The bitmap with the antinodes of all frequencies this worker claimed.
+ */
+AntinodeBitmap ResonantCollinearity::mark_frequencies(const Grid<char> &grid, bool resonant_harmonics, std::atomic<size_t> &next_frequency) const
+{
+    AntinodeBitmap bitmap(grid.get_rows(), grid.get_cols());
+    size_t idx;
+    while ((idx = next_frequency.fetch_add(1)) < frequencies.size())
     {
-        for (int j = 0; j < (int)grid[i].size(); ++j)
-        {
-            if (unique_antinode_positions.find(Position(j, i)) != unique_antinode_positions.end())
-            {
-                std::cout << "# ";
-            }
-            else
-            {
-                std::cout << grid[i][j] << " ";
-            }
-        }
-        std::cout << std::endl;
+        if (antinode_engine == AntinodeEngine::HARMONIC_LINES && resonant_harmonics)
+            frequencies[idx].mark_harmonic_lines(bitmap, grid);
+        else
+            frequencies[idx].mark_antinode_positions(bitmap, grid, resonant_harmonics);
     }
+    return bitmap;
 }
 
 /**
  * @brief Returns the set of unique antinode positions found in the grid.
  * @return An unordered_set of Position objects.
  */
-std::unordered_set<Position> ResonantCollinearity::get_unique_antinode_positions()
+std::unordered_set<Position> ResonantCollinearity::get_unique_antinode_positions() const
 {
+    if (antinode_engine != AntinodeEngine::POSITION_SETS)
+        return antinode_bitmap.get_positions();
     return unique_antinode_positions;
 }
 
@@ -170,8 +377,10 @@ std::unordered_set<Position> ResonantCollinearity::get_unique_antinode_positions
  * @brief Returns the number of unique antinode positions found in the grid.
  * @return The number of unique antinode positions.
  */
-size_t ResonantCollinearity::get_number_of_unique_antinode_positions()
+size_t ResonantCollinearity::get_number_of_unique_antinode_positions() const
 {
+    if (antinode_engine != AntinodeEngine::POSITION_SETS)
+        return antinode_bitmap.count();
     return unique_antinode_positions.size();
 }
 
@@ -180,12 +389,20 @@ size_t ResonantCollinearity::get_number_of_unique_antinode_positions()
  * @param frequency_char The character representing the frequency.
  * @param grid The 2D grid of characters.
  */
-Frequency::Frequency(char frequency_char, const std::vector<std::vector<char>> &grid)
+Frequency::Frequency(char frequency_char, const Grid<char> &grid)
     : frequency_char(frequency_char)
 {
     find_frequency_positions(grid);
 }
 
+/**
+ * @brief Constructs a Frequency object from the positions of its antennas.
+ * @param frequency_char The character representing the frequency.
+ * @param frequency_positions The positions of all antennas of the frequency.
+ */
+Frequency::Frequency(char frequency_char, std::vector<Position> frequency_positions)
+    : frequency_char(frequency_char), frequency_positions(std::move(frequency_positions)) {}
+
 /**
  * @brief Returns the character representing the frequency.
  * @return The frequency character.
@@ -199,19 +416,12 @@ char Frequency::get_frequency_char() const
  * @brief Finds all positions of the frequency in the grid and stores them.
  * @param grid The 2D grid of characters.
  */
-void Frequency::find_frequency_positions(const std::vector<std::vector<char>> &grid)
+void Frequency::find_frequency_positions(const Grid<char> &grid)
 {
-
-    for (int i = 0; i < (int)grid.size(); ++i)
-    {
-        for (int j = 0; j < (int)grid[i].size(); ++j)
-        {
-            if (grid[i][j] == frequency_char)
-            {
-                frequency_positions.insert(Position(j, i));
-            }
-        }
-    }
+    grid.for_each_index([&](size_t index)
+                        {
+        if (grid[index] == frequency_char)
+            frequency_positions.push_back(Position(grid.get_col(index), grid.get_row(index))); });
 
     //std::cout << "Found " << frequency_positions.size() << " positions for frequency: " << frequency_char << std::endl;
 }
@@ -222,12 +432,91 @@ void Frequency::find_frequency_positions(const std::vector<std::vector<char>> &g
  * @param resonant_harmonics Whether to consider resonant harmonics.
  * @return An unordered_set of Position objects.
  */
-std::unordered_set<Position> Frequency::get_antinode_positions(const std::vector<std::vector<char>> &grid, bool resonant_harmonics) const
+std::unordered_set<Position> Frequency::get_antinode_positions(const Grid<char> &grid, bool resonant_harmonics) const
 {
-    auto antinodes = find_antinode_positions_from_frequency_positions((int)grid.size(), (int)grid[0].size(), resonant_harmonics);
+    auto antinodes = find_antinode_positions_from_frequency_positions((int)grid.get_rows(), (int)grid.get_cols(), resonant_harmonics);
     return antinodes;
 }
 
+/**
+ * @brief Marks the antinode positions of this frequency in a bitmap of the grid.
+ *
+ * Both antinodes of a pair of antennas are found from either antenna, so every unordered pair is only visited once.
+ * @param antinode_bitmap The bitmap to mark the antinodes in, covering the whole grid.
+ * @param grid The 2D grid of characters.
+ * @param resonant_harmonics Whether to consider resonant harmonics (include all positions along the line).
+ */
+void Frequency::mark_antinode_positions(AntinodeBitmap &antinode_bitmap, const Grid<char> &grid, bool resonant_harmonics) const
+{
+    antenna_pairs_visited.add(frequency_positions.size() * (frequency_positions.size() - 1) / 2);
+    for (size_t i = 0; i < frequency_positions.size(); ++i)
+    {
+        for (size_t j = i + 1; j < frequency_positions.size(); ++j)
+        {
+            for_each_antinode_position(frequency_positions[j], frequency_positions[i], (int)grid.get_rows(), (int)grid.get_cols(), resonant_harmonics,
+                                       [&](int x, int y)
+                                       { antinode_bitmap.mark(x, y); });
+        }
+    }
+}
+
+/**
+ * @brief Marks every position exactly in line with at least two antennas of this frequency in a bitmap of the grid.
+ *
+ * Pairs of antennas on a line that was already walked, like any further pair of three collinear antennas, are skipped.
+ * @param antinode_bitmap The bitmap to mark the antinodes in, covering the whole grid.
+ * @param grid The 2D grid of characters.
+ */
+void Frequency::mark_harmonic_lines(AntinodeBitmap &antinode_bitmap, const Grid<char> &grid) const
+{
+    std::unordered_set<HarmonicLine> walked_lines;
+    for (size_t i = 0; i < frequency_positions.size(); ++i)
+    {
+        for (size_t j = i + 1; j < frequency_positions.size(); ++j)
+        {
+            HarmonicLine line(frequency_positions[i], frequency_positions[j]);
+            if (walked_lines.insert(line).second)
+                mark_harmonic_line(antinode_bitmap, frequency_positions[i], line, (int)grid.get_rows(), (int)grid.get_cols());
+        }
+    }
+    antenna_pairs_visited.add(frequency_positions.size() * (frequency_positions.size() - 1) / 2);
+    harmonic_lines_walked.add(walked_lines.size());
+}
+
+/**
+ * @brief Marks all positions of a line inside the grid, computing the number of steps in either direction up front.
+ * @param antinode_bitmap The bitmap to mark the positions in.
+ * @param pos A position on the line inside the grid.
+ * @param line The line to mark.
+ * @param grid_row_size Number of rows in the grid.
+ * @param grid_column_size Number of columns in the grid.
+ */
+void Frequency::mark_harmonic_line(AntinodeBitmap &antinode_bitmap, const Position &pos, const HarmonicLine &line, const int &grid_row_size, const int &grid_column_size)
+{
+    // Steps k for which pos + k * (dx, dy) stays inside the grid, per axis.
+    int min_steps = INT_MIN, max_steps = INT_MAX;
+    auto limit_steps = [&](int start, int step, int size)
+    {
+        if (step > 0)
+        {
+            min_steps = std::max(min_steps, -(start / step));
+            max_steps = std::min(max_steps, (size - 1 - start) / step);
+        }
+        else if (step < 0)
+        {
+            min_steps = std::max(min_steps, -((size - 1 - start) / -step));
+            max_steps = std::min(max_steps, start / -step);
+        }
+    };
+    limit_steps(pos.x_position, line.dx, grid_column_size);
+    limit_steps(pos.y_position, line.dy, grid_row_size);
+
+    for (int k = min_steps; k <= max_steps; ++k)
+    {
+        antinode_bitmap.mark(pos.x_position + k * line.dx, pos.y_position + k * line.dy);
+    }
+}
+
 /**
  * @brief Finds antinode positions from frequency positions in the grid.
  *
@@ -294,6 +583,23 @@ std::unordered_set<Position> Frequency::find_antinode_positions_from_frequency_p
  * @param resonant_harmonics Whether to consider resonant harmonics (continue along the line).
  */
 void Frequency::calculate_antinode_positions(std::unordered_set<Position> &antinode_positions, const Position &compare_pos, const Position &pos, const int &grid_row_size, const int &grid_column_size, bool resonant_harmonics) const
+{
+    for_each_antinode_position(compare_pos, pos, grid_row_size, grid_column_size, resonant_harmonics,
+                               [&](int x, int y)
+                               { antinode_positions.insert(Position(x, y)); });
+}
+
+/**
+ * @brief Calls a function with every antinode position of a pair of frequency positions, see calculate_antinode_positions.
+ * @param compare_pos The position of the second antenna.
+ * @param pos The position of the first antenna.
+ * @param grid_row_size Number of rows in the grid.
+ * @param grid_column_size Number of columns in the grid.
+ * @param resonant_harmonics Whether to consider resonant harmonics (continue along the line).
+ * @param function The function to call with the x and y position of every antinode.
+ */
+template <typename Function>
+void Frequency::for_each_antinode_position(const Position &compare_pos, const Position &pos, const int &grid_row_size, const int &grid_column_size, bool resonant_harmonics, Function &&function) const
 {
     // The antinode positions are twice the distance from the first position to the second
     int dx = compare_pos.x_position - pos.x_position;
@@ -308,7 +614,7 @@ void Frequency::calculate_antinode_positions(std::unordered_set<Position> &antin
     while (candidate_1_x_position > -1 && candidate_1_x_position < grid_column_size &&
            candidate_1_y_position > -1 && candidate_1_y_position < grid_row_size)
     {
-        antinode_positions.insert(Position(candidate_1_x_position, candidate_1_y_position));
+        function(candidate_1_x_position, candidate_1_y_position);
         candidate_1_x_position += dx;
         candidate_1_y_position += dy;
 
@@ -321,7 +627,7 @@ void Frequency::calculate_antinode_positions(std::unordered_set<Position> &antin
     while (candidate_2_x_position > -1 && candidate_2_x_position < grid_column_size &&
            candidate_2_y_position > -1 && candidate_2_y_position < grid_row_size)
     {
-        antinode_positions.insert(Position(candidate_2_x_position, candidate_2_y_position));
+        function(candidate_2_x_position, candidate_2_y_position);
         candidate_2_x_position -= dx;
         candidate_2_y_position -= dy;
         if (!resonant_harmonics)
@@ -332,8 +638,8 @@ void Frequency::calculate_antinode_positions(std::unordered_set<Position> &antin
 
     if (resonant_harmonics)
     {
-        antinode_positions.insert(pos);
-        antinode_positions.insert(compare_pos);
+        function(pos.x_position, pos.y_position);
+        function(compare_pos.x_position, compare_pos.y_position);
     }
 
     return;
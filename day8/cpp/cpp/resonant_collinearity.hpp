@@ -7,7 +7,30 @@
 #include <stdexcept>
 #include <unordered_set>
 #include <map>
+#include <optional>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "grid.hpp"
+
+/**
+ * @enum AntinodeEngine
+ * @brief Selects how the antinode positions of all frequencies are collected.
+ *
+ * POSITION_SETS collects the antinodes of every frequency in a set and merges the sets.
+ * DENSE_BITMAP marks the antinodes of all frequencies in one bitmap of the grid and counts the set bits.
+ * HARMONIC_LINES marks antinodes like DENSE_BITMAP. With resonant harmonics, it walks every distinct line through two antennas
+ * once, in steps reduced by their GCD, so also positions in between antennas that are exactly in line with them are marked.
+ */
+enum AntinodeEngine
+{
+    POSITION_SETS,
+    DENSE_BITMAP,
+    HARMONIC_LINES
+};
 
 /**
  * @class Position
@@ -22,6 +45,21 @@ public:
     bool operator==(const Position &other) const;
 };
 
+/**
+ * @class HarmonicLine
+ * @brief A line through the grid, given by its direction reduced by the GCD and its offset along the normal of the direction.
+ *
+ * The direction is normalised to point right, or down if the line is vertical, so every line has exactly one representation.
+ */
+class HarmonicLine
+{
+public:
+    int dx, dy;
+    long long offset;
+    HarmonicLine(const Position &pos, const Position &compare_pos);
+    bool operator==(const HarmonicLine &other) const;
+};
+
 namespace std
 {
     template <>
@@ -29,11 +67,42 @@ namespace std
     {
         std::size_t operator()(const Position &p) const
         {
-            return std::hash<int>()(p.x_position) ^ std::hash<int>()(p.y_position);
+            return std::hash<uint64_t>()(pack_position(p.x_position, p.y_position));
+        }
+    };
+
+    template <>
+    struct hash<HarmonicLine>
+    {
+        std::size_t operator()(const HarmonicLine &l) const
+        {
+            return std::hash<uint64_t>()(pack_position(l.dx, l.dy)) * 31 + std::hash<long long>()(l.offset);
         }
     };
 }
 
+/**
+ * @class AntinodeBitmap
+ * @brief Dense bitmap with one bit per cell of the grid, marking the cells holding an antinode.
+ * @param rows The number of rows of the grid.
+ * @param cols The number of columns of the grid.
+ */
+class AntinodeBitmap
+{
+public:
+    AntinodeBitmap() : rows(0), cols(0) {}
+    AntinodeBitmap(size_t rows, size_t cols);
+    void mark(int x, int y);
+    bool contains(int x, int y) const;
+    size_t count() const;
+    std::unordered_set<Position> get_positions() const;
+    AntinodeBitmap &operator|=(const AntinodeBitmap &other);
+
+private:
+    size_t rows, cols;
+    std::vector<uint64_t> words;
+};
+
 /**
  * @class Frequency
  * @brief Represents a frequency in the grid.
@@ -41,17 +110,23 @@ namespace std
 class Frequency
 {
 public:
-    Frequency(char frequency_char, const std::vector<std::vector<char>> &grid);
+    Frequency(char frequency_char, const Grid<char> &grid);
+    Frequency(char frequency_char, std::vector<Position> frequency_positions);
     char get_frequency_char() const;
-    std::unordered_set<Position> get_antinode_positions(const std::vector<std::vector<char>> &grid, bool resonant_harmonics) const;
+    std::unordered_set<Position> get_antinode_positions(const Grid<char> &grid, bool resonant_harmonics) const;
+    void mark_antinode_positions(AntinodeBitmap &antinode_bitmap, const Grid<char> &grid, bool resonant_harmonics) const;
+    void mark_harmonic_lines(AntinodeBitmap &antinode_bitmap, const Grid<char> &grid) const;
     bool operator==(const Frequency &other) const;
 
 private:
     char frequency_char;
-    std::unordered_set<Position> frequency_positions;
-    void find_frequency_positions(const std::vector<std::vector<char>> &grid);
+    std::vector<Position> frequency_positions;
+    void find_frequency_positions(const Grid<char> &grid);
+    static void mark_harmonic_line(AntinodeBitmap &antinode_bitmap, const Position &pos, const HarmonicLine &line, const int &grid_row_size, const int &grid_column_size);
     std::unordered_set<Position> find_antinode_positions_from_frequency_positions(const int &grid_row_size, const int &grid_column_size, bool resonant_harmonics) const;
     void calculate_antinode_positions(std::unordered_set<Position> &antinode_positions, const Position &compare_pos, const Position &pos, const int &grid_row_size, const int &grid_column_size, bool resonant_harmonics) const;
+    template <typename Function>
+    void for_each_antinode_position(const Position &compare_pos, const Position &pos, const int &grid_row_size, const int &grid_column_size, bool resonant_harmonics, Function &&function) const;
 };
 
 namespace std
@@ -69,35 +144,56 @@ namespace std
 /**
  * @class ResonantCollinearity
  * @brief Handles the logic for detecting resonant collinearity in a grid.
+ *
+ * The antennas are sorted into their frequencies in a single scan of the grid, or taken from an earlier scan. The bitmap
+ * engines share the frequencies between number_of_threads workers, which each mark their own bitmap; the bitmaps are
+ * then combined with a bitwise OR.
  */
 class ResonantCollinearity
 {
 public:
-    ResonantCollinearity(const std::vector<std::vector<char>> &grid, bool resonant_harmonics = false);
-    std::unordered_set<Position> get_unique_antinode_positions();
-    size_t get_number_of_unique_antinode_positions();
+    ResonantCollinearity(const Grid<char> &grid, bool resonant_harmonics = false, AntinodeEngine antinode_engine = AntinodeEngine::HARMONIC_LINES, size_t number_of_threads = 1);
+    ResonantCollinearity(const Grid<char> &grid, std::vector<Frequency> frequencies, bool resonant_harmonics, AntinodeEngine antinode_engine = AntinodeEngine::HARMONIC_LINES, size_t number_of_threads = 1);
+    std::unordered_set<Position> get_unique_antinode_positions() const;
+    size_t get_number_of_unique_antinode_positions() const;
+    static std::vector<Frequency> find_frequencies(const Grid<char> &grid);
 
 protected:
-    void process_frequencies(const std::vector<std::vector<char>> &grid, bool resonant_harmonics);
+    void process_frequencies(const Grid<char> &grid, bool resonant_harmonics);
 
 private:
+    AntinodeEngine antinode_engine;
+    size_t number_of_threads;
     std::unordered_set<Position> unique_antinode_positions;
-    std::unordered_set<Frequency> frequencies;
+    AntinodeBitmap antinode_bitmap;
+    std::vector<Frequency> frequencies;
+    AntinodeBitmap mark_frequencies(const Grid<char> &grid, bool resonant_harmonics, std::atomic<size_t> &next_frequency) const;
 };
 
 /**
  * @class ManagerClass
  * @brief Manages file I/O, setup, and analysis of antenna antinodes.
+ *
+ * The grid is read once and every query is answered from it. The antennas are sorted into their frequencies on the
+ * first query, and the antinodes of every combination of resonant harmonics and engine are marked on first use and
+ * cached, so queries can be repeated cheaply. Queries are not safe to run concurrently on the same ManagerClass.
+ * @param input_file_name The path to the input file.
+ * @param number_of_threads Number of worker threads marking the antinodes of the frequencies (0 = hardware concurrency).
  */
 class ManagerClass
 {
 public:
-    ManagerClass(const std::string &input_file_name);
-    std::unordered_set<Position> get_unique_antinode_positions();
-    size_t get_number_of_unique_antinode_positions();
-    std::unordered_set<Position> get_unique_antinode_positions_with_resonant_harmonics();
+    ManagerClass(const std::string &input_file_name, size_t number_of_threads = 1);
+    std::unordered_set<Position> get_unique_antinode_positions(AntinodeEngine antinode_engine = AntinodeEngine::HARMONIC_LINES);
+    size_t get_number_of_unique_antinode_positions(AntinodeEngine antinode_engine = AntinodeEngine::HARMONIC_LINES);
+    std::unordered_set<Position> get_unique_antinode_positions_with_resonant_harmonics(AntinodeEngine antinode_engine = AntinodeEngine::HARMONIC_LINES);
+    size_t get_number_of_unique_antinode_positions_with_resonant_harmonics(AntinodeEngine antinode_engine = AntinodeEngine::HARMONIC_LINES);
 
 private:
-    std::vector<std::vector<char>> grid;
-    std::vector<std::vector<char>> read_input(const std::string &filename);
+    Grid<char> grid;
+    size_t number_of_threads;
+    std::optional<std::vector<Frequency>> frequencies;
+    std::map<std::pair<bool, AntinodeEngine>, ResonantCollinearity> antinodes;
+    const ResonantCollinearity &get_antinodes(bool resonant_harmonics, AntinodeEngine antinode_engine);
+    Grid<char> read_input(const std::string &filename);
 };
\ No newline at end of file
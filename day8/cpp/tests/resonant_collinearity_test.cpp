@@ -1,8 +1,30 @@
 #include "gtest/gtest.h"
 // #include "gmock/gmock.h"
 #include <sstream>
+#include <random>
 #include "resonant_collinearity.hpp"
 
+/**
+ * @brief Generates a random grid with antennas of a few frequencies scattered over empty cells.
+ * @param rows The number of rows.
+ * @param cols The number of columns.
+ * @param antennas The number of antennas to place, cells may be picked more than once.
+ * @param seed The seed of the random number generator.
+ * @return The grid of characters.
+ */
+static Grid<char> random_antenna_grid(size_t rows, size_t cols, size_t antennas, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<size_t> row(0, rows - 1), col(0, cols - 1);
+    std::uniform_int_distribution<int> frequency(0, 5);
+    Grid<char> grid(rows, cols, '.');
+    for (size_t antenna = 0; antenna < antennas; ++antenna)
+    {
+        grid.at(row(generator), col(generator)) = "aB0xZ7"[frequency(generator)];
+    }
+    return grid;
+}
+
 TEST(PositionTest, EqualityOperator)
 {
     Position a(1, 2), b(1, 2), c(2, 1);
@@ -12,9 +34,9 @@ TEST(PositionTest, EqualityOperator)
 
 TEST(FrequencyTest, EqualityOperator)
 {
-    Frequency f1('A', {{'.', '.', '.'}, {'.', 'A', '.'}, {'.', '.', '.'}});
-    Frequency f2('A', {{'.', '.', '.'}, {'.', 'A', '.'}, {'.', '.', '.'}});
-    Frequency f3('B', {{'.', '.', '.'}, {'.', 'B', '.'}, {'.', '.', '.'}});
+    Frequency f1('A', Grid<char>(std::vector<std::vector<char>>{{'.', '.', '.'}, {'.', 'A', '.'}, {'.', '.', '.'}}));
+    Frequency f2('A', Grid<char>(std::vector<std::vector<char>>{{'.', '.', '.'}, {'.', 'A', '.'}, {'.', '.', '.'}}));
+    Frequency f3('B', Grid<char>(std::vector<std::vector<char>>{{'.', '.', '.'}, {'.', 'B', '.'}, {'.', '.', '.'}}));
 
     EXPECT_TRUE(f1 == f2);
     EXPECT_FALSE(f1 == f3);
@@ -22,7 +44,7 @@ TEST(FrequencyTest, EqualityOperator)
 
 TEST(ResonantCollinearityTest, UniqueAntinodePositions)
 {
-    std::vector<std::vector<char>> grid = {
+    Grid<char> grid(std::vector<std::vector<char>>{
         {'.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
         {'.', '.', '.', '.', '.', '.', '.', '.', '0', '.', '.', '.'},
         {'.', '.', '.', '.', '.', '0', '.', '.', '.', '.', '.', '.'},
@@ -35,7 +57,7 @@ TEST(ResonantCollinearityTest, UniqueAntinodePositions)
         {'.', '.', '.', '.', '.', '.', '.', '.', '.', 'A', '.', '.'},
         {'.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
         {'.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
-    };
+    });
 
     ResonantCollinearity resonant_collinearity(grid, false);
     auto antinode_positions = resonant_collinearity.get_unique_antinode_positions();
@@ -46,7 +68,7 @@ TEST(ResonantCollinearityTest, UniqueAntinodePositions)
 
 TEST(ResonantCollinearityTest, UniqueAntinodePositionsWithResonantHarmonics)
 {
-    std::vector<std::vector<char>> grid = {
+    Grid<char> grid(std::vector<std::vector<char>>{
         {'.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
         {'.', '.', '.', '.', '.', '.', '.', '.', '0', '.', '.', '.'},
         {'.', '.', '.', '.', '.', '0', '.', '.', '.', '.', '.', '.'},
@@ -59,10 +81,116 @@ TEST(ResonantCollinearityTest, UniqueAntinodePositionsWithResonantHarmonics)
         {'.', '.', '.', '.', '.', '.', '.', '.', '.', 'A', '.', '.'},
         {'.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
         {'.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
-    };
+    });
 
     ResonantCollinearity resonant_collinearity(grid, true);
     auto antinode_positions = resonant_collinearity.get_unique_antinode_positions();
 
     EXPECT_EQ(antinode_positions.size(), 34);
-}
\ No newline at end of file
+}
+
+TEST(ResonantCollinearityTest, AntinodeEnginesAgree)
+{
+    Grid<char> grid(std::vector<std::vector<char>>{
+        {'.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', '.', '.', '0', '.', '.', '.'},
+        {'.', '.', '.', '.', '.', '0', '.', '.', '.', '.', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', '.', '0', '.', '.', '.', '.'},
+        {'.', '.', '.', '.', '0', '.', '.', '.', '.', '.', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', 'A', '.', '.', '.', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', '.', '.', 'A', '.', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', '.', '.', '.', 'A', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
+        {'.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
+    });
+
+    for (bool resonant_harmonics : {false, true})
+    {
+        ResonantCollinearity position_sets(grid, resonant_harmonics, AntinodeEngine::POSITION_SETS);
+        ResonantCollinearity dense_bitmap(grid, resonant_harmonics, AntinodeEngine::DENSE_BITMAP);
+        EXPECT_EQ(dense_bitmap.get_number_of_unique_antinode_positions(), position_sets.get_number_of_unique_antinode_positions());
+        EXPECT_EQ(dense_bitmap.get_unique_antinode_positions(), position_sets.get_unique_antinode_positions());
+    }
+
+    for (unsigned seed = 0; seed < 5; ++seed)
+    {
+        auto random_grid = random_antenna_grid(37, 53, 60, seed);
+        for (bool resonant_harmonics : {false, true})
+        {
+            ResonantCollinearity position_sets(random_grid, resonant_harmonics, AntinodeEngine::POSITION_SETS);
+            ResonantCollinearity dense_bitmap(random_grid, resonant_harmonics, AntinodeEngine::DENSE_BITMAP);
+            EXPECT_EQ(dense_bitmap.get_unique_antinode_positions(), position_sets.get_unique_antinode_positions()) << "seed " << seed;
+        }
+    }
+}
+
+TEST(ResonantCollinearityTest, HarmonicLinesMarkEveryPositionInLine)
+{
+    // The antennas are two steps apart, so the positions in between are in line with them as well.
+    Grid<char> grid(std::vector<std::vector<char>>{
+        {'a', '.', '.', '.', '.'},
+        {'.', '.', '.', '.', '.'},
+        {'.', '.', 'a', '.', '.'},
+        {'.', '.', '.', '.', '.'},
+        {'.', '.', '.', '.', '.'},
+    });
+    EXPECT_EQ(ResonantCollinearity(grid, true, AntinodeEngine::HARMONIC_LINES).get_number_of_unique_antinode_positions(), 5);
+    EXPECT_EQ(ResonantCollinearity(grid, true, AntinodeEngine::DENSE_BITMAP).get_number_of_unique_antinode_positions(), 3);
+
+    for (unsigned seed = 0; seed < 5; ++seed)
+    {
+        auto random_grid = random_antenna_grid(31, 44, 40, seed);
+        // Any position in line with two antennas of the same frequency holds an antinode.
+        std::unordered_set<Position> expected;
+        std::vector<std::pair<Position, char>> antennas;
+        random_grid.for_each_index([&](size_t index)
+                                   {
+            if (random_grid[index] != '.')
+                antennas.push_back({Position(random_grid.get_col(index), random_grid.get_row(index)), random_grid[index]}); });
+        for (size_t i = 0; i < antennas.size(); ++i)
+        {
+            for (size_t j = i + 1; j < antennas.size(); ++j)
+            {
+                if (antennas[i].second != antennas[j].second)
+                    continue;
+                const Position &a = antennas[i].first, &b = antennas[j].first;
+                random_grid.for_each_index([&](size_t index)
+                                           {
+                    int x = random_grid.get_col(index), y = random_grid.get_row(index);
+                    if ((b.x_position - a.x_position) * (y - a.y_position) == (b.y_position - a.y_position) * (x - a.x_position))
+                        expected.insert(Position(x, y)); });
+            }
+        }
+        ResonantCollinearity harmonic_lines(random_grid, true, AntinodeEngine::HARMONIC_LINES);
+        EXPECT_EQ(harmonic_lines.get_unique_antinode_positions(), expected) << "seed " << seed;
+    }
+}
+
+TEST(ResonantCollinearityTest, ParallelFrequenciesMatchSerial)
+{
+    auto random_grid = random_antenna_grid(120, 90, 300, 11);
+    for (auto antinode_engine : {AntinodeEngine::DENSE_BITMAP, AntinodeEngine::HARMONIC_LINES})
+    {
+        for (bool resonant_harmonics : {false, true})
+        {
+            ResonantCollinearity serial(random_grid, resonant_harmonics, antinode_engine);
+            for (size_t number_of_threads : {2, 4, 16})
+            {
+                ResonantCollinearity parallel(random_grid, resonant_harmonics, antinode_engine, number_of_threads);
+                EXPECT_EQ(parallel.get_unique_antinode_positions(), serial.get_unique_antinode_positions()) << number_of_threads << " threads";
+            }
+        }
+    }
+}
+
+TEST(ManagerClassTest, SessionAnswersRepeatedQueries)
+{
+    ManagerClass manager("../small_puzzle_input");
+    EXPECT_EQ(manager.get_number_of_unique_antinode_positions(), 14);
+    EXPECT_EQ(manager.get_number_of_unique_antinode_positions_with_resonant_harmonics(), 34);
+    EXPECT_EQ(manager.get_unique_antinode_positions(AntinodeEngine::POSITION_SETS), manager.get_unique_antinode_positions());
+    EXPECT_EQ(manager.get_number_of_unique_antinode_positions_with_resonant_harmonics(AntinodeEngine::DENSE_BITMAP), 34);
+    EXPECT_EQ(manager.get_number_of_unique_antinode_positions(), 14);
+}
@@ -0,0 +1,52 @@
+#include "bench.hpp"
+#include "file_formatter.hpp"
+
+/**
+ * @brief Generates a disk map of alternating file and free space lengths, files are 1 to 9 and free spaces 0 to 9 blocks long.
+ * @param length The number of digits of the disk map.
+ */
+std::string generate_disk_map(bench::Generator &generator, size_t length)
+{
+    std::string disk_map;
+    for (size_t i = 0; i < length; ++i)
+    {
+        disk_map.push_back(static_cast<char>('0' + generator.uniform(i % 2 == 0 ? 1 : 0, 9)));
+    }
+    return disk_map + "\n";
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        bench::Suite suite("Disk Fragmenter", argc, argv);
+        bench::Generator generator;
+        for (size_t length : {1000 * suite.get_scale(), 20000 * suite.get_scale()})
+        {
+            std::string label = std::to_string(length);
+            std::string diskmap = generate_disk_map(generator, length);
+            std::string filename = bench::write_input("build/bench_disk_map_" + label, diskmap);
+
+            suite.run("parse@" + label, [&]
+                      { return ManagerClass(filename).get_checksum(); });
+            suite.run("checksum@" + label + "/FREE_SPACE_SWAP", [&]
+                      { return FileFormatter(diskmap, true).get_checksum(); });
+            suite.run("checksum@" + label + "/TWO_POINTER", [&]
+                      { return FileFormatter(diskmap, true).get_two_pointer_checksum(); });
+            suite.run("checksum_for_whole_files@" + label, [&]
+                      { return FileFormatter(diskmap, false).get_checksum(); });
+            suite.run("both_parts@" + label + "/MANAGER_PER_PART", [&]
+                      { return ManagerClass(filename).get_checksum() + ManagerClass(filename).get_checksum_for_whole_files(); });
+            suite.run("both_parts@" + label + "/SESSION", [&]
+                      {
+                          ManagerClass manager(filename);
+                          return manager.get_checksum() + manager.get_checksum_for_whole_files(); });
+        }
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -3,14 +3,19 @@
  * @brief Implements disk map parsing, file and free space management, and checksum calculation logic.
  */
 #include "file_formatter.hpp"
+#include "instrumentation.hpp"
+
+static instrumentation::Counter files_parsed("files_parsed");
+static instrumentation::Counter free_spaces_parsed("free_spaces_parsed");
+static instrumentation::Counter file_moves("file_moves");
 
 /**
  * @brief Constructs a FileFormatter object and parses the original disk map.
- * @param original_diskmap The original disk map as a vector of characters.
+ * @param original_diskmap Non-owning view of the original disk map characters, only read during construction.
  * @param fragmentation_allowed Whether fragmentation is allowed for files.
  */
-FileFormatter::FileFormatter(const std::vector<char> &original_diskmap, bool fragmentation_allowed)
-    : original_diskmap(original_diskmap), fragmentation_allowed(fragmentation_allowed)
+FileFormatter::FileFormatter(std::span<const char> original_diskmap, bool fragmentation_allowed)
+    : fragmentation_allowed(fragmentation_allowed)
 {
     parse_original_diskmap(original_diskmap, fragmentation_allowed);
     //std::cout << "Diskmap size: " << diskmap_size << std::endl;
@@ -37,13 +42,14 @@ std::string FileFormatter::convert_file_id_to_str(size_t file_id){
 
 /**
  * @brief Parses the original disk map and populates file and free space vectors.
- * @param original_diskmap The original disk map as a vector of characters.
+ * @param original_diskmap View of the original disk map characters.
  * @param fragmentation_allowed Whether fragmentation is allowed for files.
  * 
- * The number in the original diskmap represents number of file fragments or free space size.
- * Even indices represent file blocks and odd indices represent free space.
+ * The number in the original diskmap represents number of file blocks or free space size.
+ * Even indices represent files and odd indices represent free space. Each file is stored as a single extent
+ * instead of one object per block.
  */
-void FileFormatter::parse_original_diskmap(const std::vector<char> &original_diskmap, bool fragmentation_allowed)
+void FileFormatter::parse_original_diskmap(std::span<const char> original_diskmap, bool fragmentation_allowed)
 {   
     diskmap_size = 0;
     number_of_file_fragments = 0;
@@ -51,15 +57,11 @@ void FileFormatter::parse_original_diskmap(const std::vector<char> &original_dis
     {
         if (i % 2 == 0)
         {
-            std::vector<FileFragment> file_fragments;
-            for (size_t j = 0; j < convert_char_to_file_id(original_diskmap[i]); ++j)
-            {
-                // The file ID (i/2) is based on the order of the files in the original diskmap.
-                file_fragments.push_back(FileFragment(i / 2, diskmap_size));
-                diskmap_size++;
-                number_of_file_fragments++;
-            }
-            diskmap_files.push_back(File(file_fragments, fragmentation_allowed));
+            // The file ID (i/2) is based on the order of the files in the original diskmap.
+            auto file_size = convert_char_to_file_id(original_diskmap[i]);
+            diskmap_files.push_back(File(i / 2, diskmap_size, file_size, fragmentation_allowed));
+            diskmap_size += file_size;
+            number_of_file_fragments += file_size;
         }
         else
         {
@@ -72,6 +74,8 @@ void FileFormatter::parse_original_diskmap(const std::vector<char> &original_dis
         }
         continue;
     }
+    files_parsed.add(diskmap_files.size());
+    free_spaces_parsed.add(diskmap_free_space.size());
 }
 
 /**
@@ -92,10 +96,57 @@ size_t FileFormatter::get_checksum()
     }
 
     // std::cout << "Post Formatting ";
-    print_diskmap_order();
+    // print_diskmap_order();
     return calculate_checksum();
 }
 
+/**
+ * @brief Calculates the checksum of the disk map after compacting single blocks, in one linear pass.
+ *
+ * A left cursor walks the files in disk order and a right cursor takes blocks off the last file that has not
+ * been placed yet. Every block that lands in a gap is accounted for as part of an extent at the current position,
+ * so no file or free space is modified and no moved blocks are stored.
+ * @return The calculated checksum value.
+ */
+size_t FileFormatter::get_two_pointer_checksum() const
+{
+    if (diskmap_files.empty())
+        return 0;
+
+    size_t checksum = 0;
+    size_t position = 0;
+    size_t left = 0;
+    size_t right = diskmap_files.size() - 1;
+    size_t right_remaining = diskmap_files[right].size;
+    while (left < right)
+    {
+        const File &left_file = diskmap_files[left];
+        checksum += FileExtent(left_file.file_id, position, left_file.size).get_checksum();
+        position += left_file.size;
+
+        size_t gap = diskmap_files[left + 1].start_position - (left_file.start_position + left_file.size);
+        while (gap > 0 && left < right)
+        {
+            size_t moved = std::min(gap, right_remaining);
+            checksum += FileExtent(diskmap_files[right].file_id, position, moved).get_checksum();
+            position += moved;
+            gap -= moved;
+            right_remaining -= moved;
+            if (right_remaining == 0)
+            {
+                --right;
+                right_remaining = diskmap_files[right].size;
+            }
+        }
+        ++left;
+    }
+
+    // The last file to be placed keeps whatever was not moved into a gap.
+    if (left == right)
+        checksum += FileExtent(diskmap_files[right].file_id, position, right_remaining).get_checksum();
+    return checksum;
+}
+
 /**
  * @brief Prints the current disk map order as a vector of characters.
  * @return A vector of characters representing the disk map order.
@@ -105,9 +156,17 @@ std::vector<std::string> FileFormatter::print_diskmap_order()
     std::vector<std::string> printer(diskmap_size, ".");
     for (const auto &v : diskmap_files)
     {
-        for (auto &fragment : v.file_fragments)
+        auto print_extent = [&](const FileExtent &extent)
+        {
+            for (size_t pos = extent.start_position; pos < extent.start_position + extent.length; ++pos)
+            {
+                printer.at(pos) = convert_file_id_to_str(extent.file_id);
+            }
+        };
+        print_extent(v.file_extent);
+        for (const auto &extent : v.moved_extents)
         {
-            printer.at(fragment.current_position) = convert_file_id_to_str(fragment.file_id);
+            print_extent(extent);
         }
     }
     std::cout << "Diskmap Order: " << std::endl;
@@ -132,32 +191,32 @@ void FileFormatter::print_diskmap_information()
 }
 
 /**
- * @brief Prints detailed information about a single file and its fragments.
+ * @brief Prints detailed information about a single file and its extents.
  * @param file The file to print information for.
  */
 void FileFormatter::print_file_information(const File &file)
 {
     std::cout << "File(size=" << file.size << ", start_position=" << file.start_position << ", modification=" << file.file_modification << ", fragmentation_allowed=" << file.fragmentation_allowed << ")" << std::endl;
 
-    for (auto &fragment : file.file_fragments)
+    std::cout << "Extent " << file.file_extent << " with position " << file.file_extent.start_position << std::endl;
+    for (auto &extent : file.moved_extents)
     {
-        std::cout << "Fragment " << fragment << " with position " << fragment.current_position << std::endl;
+        std::cout << "Extent " << extent << " with position " << extent.start_position << std::endl;
     }
 }
 
 /**
- * @brief Calculates the checksum by summing position multiplied by file_id for all fragments.
+ * @brief Calculates the checksum by summing position multiplied by file_id for all file blocks.
+ *
+ * Each extent contributes in closed form, so the cost is linear in the number of extents rather than blocks.
  * @return The calculated checksum value.
  */
 size_t FileFormatter::calculate_checksum()
 {
     size_t checksum = 0;
-    for (auto &obj : diskmap_files)
+    for (const auto &obj : diskmap_files)
     {
-        for (auto &fragment : obj.file_fragments)
-        {
-            checksum += (fragment.current_position * fragment.file_id);
-        }
+        checksum += obj.get_checksum();
     }
     return checksum;
 }
@@ -189,6 +248,7 @@ void FileFormatter::swap_free_space_with_file(FreeSpace &free_space)
         File &file = *backwards_it;
         if (file.update_file_positions(free_space))
         {
+            file_moves.add();
             //  The file fragments were used to fill some or all of the free space.
             if (free_space.size > 0)
             {
@@ -213,29 +273,24 @@ void FileFormatter::swap_free_space_with_file(FreeSpace &free_space)
 
 /**
  * @brief Formats the disk map by moving whole files into free space (no fragmentation).
+ *
+ * Each file, from the last to the first, is moved into the leftmost free space before it that is large enough.
+ * The free space is looked up in a FreeSpaceIndex instead of scanning all free space blocks for every file.
  */
 void FileFormatter::format_diskmap_no_fragmentation()
 {
+    FreeSpaceIndex free_space_index(diskmap_free_space);
     for (auto backwards_it = diskmap_files.end() - 1; backwards_it >= diskmap_files.begin(); --backwards_it)
     {
         File &file = *backwards_it;
-        find_free_space(file);
-    }
-}
+        auto free_space_idx = free_space_index.take_leftmost_free_space(file.size, file.start_position);
+        if (!free_space_idx)
+            continue;
 
-/**
- * @brief Finds free space for a given file and attempts to move it.
- * @param file The file to move into free space.
- */
-void FileFormatter::find_free_space(File &file)
-{
-    for (auto forwards_it = diskmap_free_space.begin(); forwards_it < diskmap_free_space.end(); ++forwards_it)
-    {
-        FreeSpace &free_space = *forwards_it;
-        if (free_space.start_position > file.start_position)
-            return;
-        if (file.update_file_positions(free_space))
-            return;
+        FreeSpace &free_space = diskmap_free_space[*free_space_idx];
+        file.update_file_positions(free_space);
+        file_moves.add();
+        free_space_index.add_free_space(*free_space_idx, free_space.size);
     }
 }
 
@@ -264,3 +319,62 @@ void FileFormatter::swap_free_space_with_file(FreeSpace &free_space, std::vector
     }
     return;
 }
+
+/**
+ * @brief Constructs a FreeSpaceIndex over all free space blocks of a disk map.
+ * @param free_space The free space blocks, ordered by start position.
+ */
+FreeSpaceIndex::FreeSpaceIndex(const std::vector<FreeSpace> &free_space)
+    : free_space(free_space)
+{
+    for (size_t idx = 0; idx < free_space.size(); ++idx)
+    {
+        add_free_space(idx, free_space[idx].size);
+    }
+}
+
+/**
+ * @brief Finds and removes the leftmost free space block with at least min_size blocks that starts before a position.
+ *
+ * The caller is expected to add the block back with add_free_space if it still has space left after using it.
+ * @param min_size The minimum size of the free space.
+ * @param before_position The position the free space has to start before.
+ * @return The index of the free space block, or std::nullopt if there is none.
+ */
+std::optional<size_t> FreeSpaceIndex::take_leftmost_free_space(size_t min_size, size_t before_position)
+{
+    std::optional<size_t> leftmost_size;
+    for (size_t size = std::max<size_t>(min_size, 1); size < free_space_by_size.size(); ++size)
+    {
+        auto &heap = free_space_by_size[size];
+        if (heap.empty())
+            continue;
+        if (!leftmost_size || heap.top() < free_space_by_size[*leftmost_size].top())
+            leftmost_size = size;
+    }
+
+    if (!leftmost_size)
+        return std::nullopt;
+
+    auto &heap = free_space_by_size[*leftmost_size];
+    size_t free_space_idx = heap.top();
+    if (free_space[free_space_idx].start_position >= before_position)
+        return std::nullopt;
+
+    heap.pop();
+    return free_space_idx;
+}
+
+/**
+ * @brief Adds a free space block to the index under its current size.
+ * @param free_space_index The index of the free space block.
+ * @param size The current size of the free space block. Blocks without space are not indexed.
+ */
+void FreeSpaceIndex::add_free_space(size_t free_space_index, size_t size)
+{
+    if (size == 0)
+        return;
+    if (size >= free_space_by_size.size())
+        free_space_by_size.resize(size + 1);
+    free_space_by_size[size].push(free_space_index);
+}
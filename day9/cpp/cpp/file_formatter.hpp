@@ -11,6 +11,11 @@
 #include <fstream>
 #include <stdexcept>
 #include <algorithm>
+#include <queue>
+#include <functional>
+#include <map>
+#include <optional>
+#include <span>
 
 /**
  * @enum FileModification
@@ -23,6 +28,19 @@ enum FileModification
     FULLY_MODIFIED
 };
 
+/**
+ * @enum CompactionEngine
+ * @brief Selects the algorithm used to compact a disk map when fragmentation is allowed.
+ *
+ * TWO_POINTER computes the checksum in a single linear pass without moving anything,
+ * FREE_SPACE_SWAP moves file blocks into each free space block in place.
+ */
+enum CompactionEngine
+{
+    TWO_POINTER,
+    FREE_SPACE_SWAP
+};
+
 /**
  * @class FreeSpace
  * @brief Represents a free space block on the disk, displayed as a dot ('.').
@@ -43,50 +61,53 @@ public:
 };
 
 /**
- * @class FileFragment
- * @brief Represents a file fragment on the disk, identified by a file ID.
- * @param file_id The file ID for this fragment.
- * @param current_position The current position of the fragment on the disk.
- * @param fragment_modification Modification status of the fragment.
+ * @class FileExtent
+ * @brief Represents a contiguous run of blocks on the disk that all belong to the same file.
+ * @param file_id The file ID of the blocks.
+ * @param start_position The position of the first block of the extent.
+ * @param length The number of blocks in the extent.
  */
-class FileFragment
+class FileExtent
 {
 public:
-    FileFragment(size_t file_id, size_t current_position);
+    FileExtent(size_t file_id, size_t start_position, size_t length);
     size_t file_id;
-    size_t current_position;
-    enum FileModification fragment_modification;
-    friend std::ostream &operator<<(std::ostream &os, const FileFragment &file);
+    size_t start_position;
+    size_t length;
+    size_t get_checksum() const;
+    friend std::ostream &operator<<(std::ostream &os, const FileExtent &file_extent);
 };
 
 /**
  * @class File
- * @brief Represents a collection of file fragments belonging to a single file on the disk.
- * @param fragments Vector of file fragments.
+ * @brief Represents a single file on the disk as the extents that hold its blocks.
+ *
+ * A file starts out as a single extent. Moving the entire file relocates that extent, while fragmenting
+ * shrinks it from the end and records the blocks moved into each free space block as a new extent.
+ * @param file_id The file ID of the file.
+ * @param size Number of blocks in the file.
+ * @param start_position Starting position of the file in the original disk map.
+ * @param file_extent The extent holding the blocks that have not been split off the file.
+ * @param moved_extents The extents of the blocks that were split off into free space.
  * @param fragmentation_allowed Whether fragmentation is allowed for this file.
- * @param size Number of fragments in the file.
- * @param start_position Starting position of the file.
  * @param file_modification Modification status of the file.
  * @param move_attempted Whether a move has been attempted for the file.
  */
 class File
 {
 public:
-    File() = default;
-    File(std::vector<FileFragment> fragments, bool fragmentation_allowed);
-    File(const File &other);
-    File(File &&other) noexcept;
-    File &operator=(const File &other);
-    File &operator=(File &&other) noexcept;
-    ~File() = default;
+    File(size_t file_id, size_t start_position, size_t size, bool fragmentation_allowed);
 
+    size_t file_id;
     size_t size;
     size_t start_position;
-    std::vector<FileFragment> file_fragments;
+    FileExtent file_extent;
+    std::vector<FileExtent> moved_extents;
     bool fragmentation_allowed;
     enum FileModification file_modification;
     bool move_attempted;
     bool update_file_positions(FreeSpace &free_space);
+    size_t get_checksum() const;
     friend std::ostream &operator<<(std::ostream &os, const File &file);
 
 private:
@@ -112,39 +133,61 @@ public:
     friend std::ostream &operator<<(std::ostream &os, const EmptySpace &empty_space);
 };
 
+/**
+ * @class FreeSpaceIndex
+ * @brief Index over the free space blocks of a disk map, answering "leftmost free space of at least n blocks before position p".
+ *
+ * Keeps one min-heap of free space indices per free space size. Free space blocks never overlap and only
+ * shrink from the left, so the order of their indices matches the order of their start positions.
+ * A query inspects the top of each heap of sufficient size, which is constant time for the sizes 1-9 of a disk map.
+ * @param free_space The free space blocks, ordered by start position.
+ */
+class FreeSpaceIndex
+{
+public:
+    FreeSpaceIndex(const std::vector<FreeSpace> &free_space);
+    std::optional<size_t> take_leftmost_free_space(size_t min_size, size_t before_position);
+    void add_free_space(size_t free_space_index, size_t size);
+
+private:
+    const std::vector<FreeSpace> &free_space;
+    std::vector<std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>>> free_space_by_size;
+};
+
 /**
  * @class FileFormatter
  * @brief Handles parsing, formatting, and checksum calculation for disk maps.
- * @param original_diskmap The original disk map as a vector of characters.
+ *
+ * The disk map is only read while constructing, the formatter keeps its own extents and no copy of the input.
+ * @param original_diskmap Non-owning view of the original disk map characters.
  * @param fragmentation_allowed Whether fragmentation is allowed for files.
  * @param diskmap_size The total size of the disk map.
  * @param diskmap_free_space Vector of free space blocks.
  * @param diskmap_files Vector of files.
- * @param number_of_file_fragments Total number of file fragments.
+ * @param number_of_file_fragments Total number of file blocks.
  */
 class FileFormatter
 {
 public:
-    FileFormatter(const std::vector<char> &original_diskmap, bool fragmentation_allowed);
+    FileFormatter(std::span<const char> original_diskmap, bool fragmentation_allowed);
     size_t get_checksum();
+    size_t get_two_pointer_checksum() const;
     std::vector<std::string> print_diskmap_order();
 
 private:
     size_t number_of_file_fragments;
-    std::vector<char> original_diskmap;
     bool fragmentation_allowed;
     size_t convert_char_to_file_id(char c);
     std::string convert_file_id_to_str(size_t file_id);
     size_t diskmap_size;
     std::vector<FreeSpace> diskmap_free_space;
     std::vector<File> diskmap_files;
-    void parse_original_diskmap(const std::vector<char> &original_diskmap, bool fragmentation_allowed);
+    void parse_original_diskmap(std::span<const char> original_diskmap, bool fragmentation_allowed);
     void format_diskmap();
     void format_diskmap_no_fragmentation();
     size_t calculate_checksum();
     void print_diskmap_information();
     void print_file_information(const File &file);
-    void find_free_space(File &file);
     void swap_free_space_with_file(FreeSpace &free_space);
     void swap_free_space_with_file(FreeSpace &free_space, std::vector<File>::iterator &backwards_it);
 };
@@ -152,6 +195,9 @@ private:
 /**
  * @class ManagerClass
  * @brief Handles reading the disk map from file and providing the checksum interface.
+ *
+ * The disk map is read once and every query is answered from it. Each checksum is calculated on first use and
+ * cached, so queries can be repeated cheaply. Queries are not safe to run concurrently on the same ManagerClass.
  * @param input_file_name The path to the input file.
  * @param original_diskmap The original disk map as a vector of characters.
  */
@@ -159,10 +205,12 @@ class ManagerClass
 {
 public:
     ManagerClass(const std::string &input_file_name);
-    size_t get_checksum();
+    size_t get_checksum(CompactionEngine compaction_engine = CompactionEngine::TWO_POINTER);
     size_t get_checksum_for_whole_files();
 
 private:
     std::vector<char> original_diskmap;
+    std::map<CompactionEngine, size_t> checksums;
+    std::optional<size_t> checksum_for_whole_files;
     std::vector<char> read_input(const std::string &filename);
 };
\ No newline at end of file
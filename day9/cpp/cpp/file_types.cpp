@@ -1,6 +1,6 @@
 /**
  * @file file_types.cpp
- * @brief Implements classes and methods for file fragments, free space, empty space, and file management on a disk map.
+ * @brief Implements classes and methods for file extents, free space, empty space, and file management on a disk map.
  */
 #include "file_formatter.hpp"
 
@@ -71,102 +71,63 @@ std::ostream &operator<<(std::ostream &os, const EmptySpace &empty_space)
 }
 
 /**
- * @brief Constructs a FileFragment object.
- * @param file_id The file ID for this fragment.
- * @param current_position The current position of the fragment on the disk.
+ * @brief Constructs a FileExtent object.
+ * @param file_id The file ID of the blocks.
+ * @param start_position The position of the first block of the extent.
+ * @param length The number of blocks in the extent.
  */
-FileFragment::FileFragment(size_t file_id, size_t current_position)
+FileExtent::FileExtent(size_t file_id, size_t start_position, size_t length)
     : file_id(file_id),
-      current_position(current_position),
-      fragment_modification(NEVER_MODIFIED) {};
+      start_position(start_position),
+      length(length) {};
+
+/**
+ * @brief Calculates the checksum contribution of the extent in closed form.
+ *
+ * The positions start_position, ..., start_position + length - 1 sum to
+ * start_position * length + length * (length - 1) / 2, so the extent contributes file_id times that sum.
+ * @return The sum of position multiplied by file_id over all blocks of the extent.
+ */
+size_t FileExtent::get_checksum() const
+{
+    return file_id * (start_position * length + length * (length - 1) / 2);
+}
 
 /**
- * @brief Output stream operator for FileFragment.
+ * @brief Output stream operator for FileExtent.
  * @param os The output stream.
- * @param file_fragment The FileFragment to print.
+ * @param file_extent The FileExtent to print, one file ID per block.
  * @return The output stream.
  */
-std::ostream &operator<<(std::ostream &os, const FileFragment &file_fragment)
+std::ostream &operator<<(std::ostream &os, const FileExtent &file_extent)
 {
-    os << file_fragment.file_id;
+    for (size_t i = 0; i < file_extent.length; ++i)
+    {
+        os << file_extent.file_id;
+    }
     return os;
 }
 
 /**
- * @brief Constructs a File object from fragments and fragmentation flag.
- * @param fragments Vector of file fragments.
+ * @brief Constructs a File object occupying a single extent.
+ * @param file_id The file ID of the file.
+ * @param start_position Starting position of the file.
+ * @param size Number of blocks in the file.
  * @param fragmentation_allowed Whether fragmentation is allowed for this file.
  */
-File::File(std::vector<FileFragment> fragments, bool fragmentation_allowed)
-    : size(fragments.size()),
-      start_position(fragments[0].current_position),
-      file_fragments(std::move(fragments)),
+File::File(size_t file_id, size_t start_position, size_t size, bool fragmentation_allowed)
+    : file_id(file_id),
+      size(size),
+      start_position(start_position),
+      file_extent(file_id, start_position, size),
       fragmentation_allowed(fragmentation_allowed),
       file_modification(FileModification::NEVER_MODIFIED),
       move_attempted(false) {};
 
 /**
- * @brief Copy constructor for File.
- * @param other The File object to copy from.
- */
-File::File(const File &other)
-    : size(other.size),
-      start_position(other.start_position),
-      file_fragments(other.file_fragments),
-      fragmentation_allowed(other.fragmentation_allowed),
-      file_modification(other.file_modification) {};
-
-/**
- * @brief Move constructor for File.
- * @param other The File object to move from.
- */
-File::File(File &&other) noexcept
-    : size(other.size),
-      start_position(other.start_position),
-      file_fragments(std::move(other.file_fragments)),
-      fragmentation_allowed(other.fragmentation_allowed),
-      file_modification(other.file_modification) {};
-
-/**
- * @brief Copy assignment operator for File.
- * @param other The File object to copy from.
- * @return Reference to this File object.
- */
-File &File::operator=(const File &other)
-{
-    if (this != &other)
-    {
-        size = other.size;
-        start_position = other.start_position;
-        file_fragments = other.file_fragments;
-        fragmentation_allowed = other.fragmentation_allowed;
-        file_modification = other.file_modification;
-    }
-    return *this;
-};
-
-/**
- * @brief Move assignment operator for File.
- * @param other The File object to move from.
- * @return Reference to this File object.
- */
-File &File::operator=(File &&other) noexcept
-{
-    if (this != &other)
-    {
-        size = other.size;
-        start_position = other.start_position;
-        file_fragments = std::move(other.file_fragments);
-        fragmentation_allowed = other.fragmentation_allowed;
-        file_modification = other.file_modification;
-    }
-    return *this;
-};
-
-/**
- * @brief Updates file fragment positions using available free space.
- * @param free_space The free space block to use for moving fragments.
- * @return True if any fragments were moved, false otherwise.
+ * @brief Updates file positions using available free space.
+ * @param free_space The free space block to use for moving blocks.
+ * @return True if any blocks were moved, false otherwise.
  */
 bool File::update_file_positions(FreeSpace &free_space)
 {
@@ -180,29 +141,24 @@ bool File::update_file_positions(FreeSpace &free_space)
     }
     else
     {
-        /* if(move_attempted){
-            return false;
-        } */
         return update_entire_file_positions(free_space);
     }
 }
 
 /**
  * @brief Updates fragmented file positions using available free space.
- * @param free_space The free space block to use for moving fragments.
- * @return True if any fragments were moved, false otherwise.
+ * @param free_space The free space block to use for moving blocks.
+ * @return True if any blocks were moved, false otherwise.
  */
 bool File::update_fragmented_file_positions(FreeSpace &free_space)
 {
     auto counter = update_pos(free_space);
+    if (counter > 0)
+    {
+        this->moved_extents.push_back(FileExtent(this->file_id, free_space.start_position - counter, counter));
+    }
 
-    bool all_fragments_modified = std::all_of(this->file_fragments.begin(), this->file_fragments.end(),
-                                              [first = this->file_fragments[0].fragment_modification](const FileFragment &fragment)
-                                              {
-                                                  return fragment.fragment_modification == FileModification::FULLY_MODIFIED;
-                                              });
-
-    if (all_fragments_modified)
+    if (this->file_extent.length == 0)
     {
         this->file_modification = FileModification::FULLY_MODIFIED;
     }
@@ -226,45 +182,30 @@ bool File::update_entire_file_positions(FreeSpace &free_space)
     this->move_attempted = true;
     if (free_space.size >= this->size)
     {
-        // std::cout << "FreeSpace size larger than number of file fragments, we can add this to the free space." << std::endl;
+        this->file_extent.start_position = free_space.start_position;
         update_pos(free_space);
         this->file_modification = FileModification::FULLY_MODIFIED;
         return true;
     }
     else
     {
-        // std::cout << "FreeSpace size smaller than number of file fragments, cannot use file fragments for " << this->file_fragments[0] <<"." << std::endl;
         return false;
     }
 }
 
 /**
- * @brief Updates fragment positions and modifies free space accordingly.
- * @param free_space The free space block to use for moving fragments.
- * @return Number of fragments moved.
+ * @brief Takes as many blocks as fit into the free space off the end of the file extent and modifies free space accordingly.
+ *
+ * The caller decides where the taken blocks end up, they occupy the start of the free space block before the update.
+ * @param free_space The free space block to use for moving blocks.
+ * @return Number of blocks moved.
  */
 size_t File::update_pos(FreeSpace &free_space)
 {
-    int search_index = this->file_fragments.size() - 1;
-    size_t counter = 0;
-    bool found_replacement = false;
-    for (size_t available_pos = free_space.start_position; available_pos < free_space.start_position + free_space.size; ++available_pos)
+    size_t counter = std::min(this->file_extent.length, free_space.size);
+    if (this->fragmentation_allowed)
     {
-        found_replacement = false;
-        while (!found_replacement)
-        {
-            if (search_index < 0)
-                break;
-
-            if (this->file_fragments[search_index].fragment_modification != FileModification::FULLY_MODIFIED)
-            {
-                this->file_fragments[search_index].current_position = available_pos;
-                this->file_fragments[search_index].fragment_modification = FileModification::FULLY_MODIFIED;
-                ++counter;
-                found_replacement = true;
-            }
-            --search_index;
-        }
+        this->file_extent.length -= counter;
     }
 
     free_space.size -= counter;
@@ -272,6 +213,20 @@ size_t File::update_pos(FreeSpace &free_space)
     return counter;
 }
 
+/**
+ * @brief Calculates the checksum contribution of all extents of the file.
+ * @return The sum of position multiplied by file_id over all blocks of the file.
+ */
+size_t File::get_checksum() const
+{
+    size_t checksum = file_extent.get_checksum();
+    for (const auto &extent : moved_extents)
+    {
+        checksum += extent.get_checksum();
+    }
+    return checksum;
+}
+
 /**
  * @brief Output stream operator for File.
  * @param os The output stream.
@@ -280,9 +235,10 @@ size_t File::update_pos(FreeSpace &free_space)
  */
 std::ostream &operator<<(std::ostream &os, const File &file)
 {
-    for (const auto &fragment : file.file_fragments)
+    os << file.file_extent;
+    for (const auto &extent : file.moved_extents)
     {
-        os << fragment;
+        os << extent;
     }
     return os;
 }
@@ -1,28 +1,46 @@
 #include "file_formatter.hpp"
+#include "batch.hpp"
+#include "instrumentation.hpp"
 
 /**
  * @brief Entry point. Runs the simulation and prints the results for part one and part two.
+ *
+ * Usage: disk_fragmenter [input_file]
+ *        disk_fragmenter --batch [--format=csv|json] [--workers=<n>] [--list=<file>] [<file or directory>...]
+ * The batch mode solves every input on a pool of workers and streams one result per input to stdout, see batch.hpp.
+ * Built with INSTRUMENTATION=1, the counters and phase timings are written to stderr as JSON.
  */
 int main(int argc, char *argv[])
 {
+    if (argc > 1 && std::string(argv[1]) == "--batch")
+    {
+        return batch::run_from_command_line(std::vector<std::string>(argv + 2, argv + argc), [](const std::string &filename)
+                                            {
+                                                ManagerClass manager(filename);
+                                                return batch::Answers{manager.get_checksum(), manager.get_checksum_for_whole_files()}; });
+    }
+
     std::cout << "Disk Fragmenter Simulation\n";
     std::cout << "==========================\n";
     std::string filename;
-    if (argc > 2)
+    if (argc > 1)
     {
         std::cout << "Filename provided: " << argv[1] << " \n";
         filename = argv[1];
     }
-    else if (argc < 2)
+    else
     {
         filename = "../puzzle_input";
         filename = "../small_puzzle_input";
         std::cout << "No input file provided. Using default filename " << filename << "\n";
     }
 
-    auto checksum = ManagerClass(filename).get_checksum();
+    ManagerClass manager(filename);
+    auto checksum = manager.get_checksum();
     std::cout << "Part One: " << checksum << std::endl << std::endl << std::endl;
 
-    auto checksum_two = ManagerClass(filename).get_checksum_for_whole_files();
+    auto checksum_two = manager.get_checksum_for_whole_files();
     std::cout << "Part Two: " << checksum_two << "\n";
-}
\ No newline at end of file
+
+    instrumentation::write_json(std::cerr);
+}
@@ -1,4 +1,10 @@
 #include "file_formatter.hpp"
+#include "instrumentation.hpp"
+
+#include <array>
+
+static instrumentation::Phase parse_phase("parse");
+static instrumentation::Phase compute_phase("compute");
 
 /**
  * @brief Constructs a ManagerClass and reads the disk map from file.
@@ -12,27 +18,36 @@ ManagerClass::ManagerClass(const std::string &input_file_name)
 /**
  * @brief Reads the disk map from the input file.
  *
- * Reads all non-whitespace characters from the file and returns them as a vector of characters.
+ * Streams the file in fixed size chunks and keeps all non-whitespace characters, so the disk map is
+ * held in memory exactly once instead of also being buffered line by line.
  * @param filename The path to the input file.
  * @return A vector of characters representing the disk map.
  * @throws std::runtime_error if the file does not exist or is empty.
  */
 std::vector<char> ManagerClass::read_input(const std::string &filename)
 {
+    instrumentation::ScopedTimer parse_timer(parse_phase);
     std::vector<char> diskmap;
-    std::ifstream infile(filename);
+    std::ifstream infile(filename, std::ios::binary | std::ios::ate);
     if (!infile)
     {
         throw std::runtime_error("Error: The file " + filename + " does not exist.");
     }
-    std::string line;
-    while (std::getline(infile, line))
+    auto file_size = infile.tellg();
+    if (file_size > 0)
+    {
+        diskmap.reserve(static_cast<size_t>(file_size));
+    }
+    infile.seekg(0);
+
+    std::array<char, 1 << 16> chunk;
+    while (infile.read(chunk.data(), chunk.size()) || infile.gcount() > 0)
     {
-        for (char c : line)
+        for (auto it = chunk.begin(); it != chunk.begin() + infile.gcount(); ++it)
         {
-            if (c != '\n' && c != '\r' && c != ' ')
+            if (*it != '\n' && *it != '\r' && *it != ' ')
             {
-                diskmap.push_back(c);
+                diskmap.push_back(*it);
             }
         }
     }
@@ -44,21 +59,38 @@ std::vector<char> ManagerClass::read_input(const std::string &filename)
 }
 
 /**
- * @brief Returns the checksum of the disk map using FileFormatter.
+ * @brief Returns the checksum of the disk map using FileFormatter and moving single blocks.
+ *
+ * The checksum is calculated on the first call for each engine, later calls return the cached value.
+ * @param compaction_engine The algorithm used for compacting, the linear two pointer pass by default.
  * @return The calculated checksum value.
  */
-size_t ManagerClass::get_checksum()
+size_t ManagerClass::get_checksum(CompactionEngine compaction_engine)
 {
+    auto cached = checksums.find(compaction_engine);
+    if (cached != checksums.end())
+        return cached->second;
+
+    instrumentation::ScopedTimer compute_timer(compute_phase);
     FileFormatter file_formatter(original_diskmap, true);
-    return file_formatter.get_checksum();
+    size_t checksum = compaction_engine == CompactionEngine::TWO_POINTER ? file_formatter.get_two_pointer_checksum()
+                                                                         : file_formatter.get_checksum();
+    checksums.emplace(compaction_engine, checksum);
+    return checksum;
 }
 
 /**
  * @brief Returns the checksum of the disk map using FileFormatter and rearraning whole files.
+ *
+ * The checksum is calculated on the first call, later calls return the cached value.
  * @return The calculated checksum value.
  */
 size_t ManagerClass::get_checksum_for_whole_files()
 {
-    FileFormatter file_formatter(original_diskmap, false);
-    return file_formatter.get_checksum();
+    if (!checksum_for_whole_files)
+    {
+        instrumentation::ScopedTimer compute_timer(compute_phase);
+        checksum_for_whole_files = FileFormatter(original_diskmap, false).get_checksum();
+    }
+    return *checksum_for_whole_files;
 }
\ No newline at end of file
@@ -7,8 +7,85 @@
 #include "gtest/gtest.h"
 // #include "gmock/gmock.h"
 #include <sstream>
+#include <random>
+#include <fstream>
+#include <cstdio>
 #include "file_formatter.hpp"
 
+/**
+ * @brief Reference checksum computed on an explicit block array, used to cross-check the formatter.
+ * @param diskmap The original disk map as a vector of characters.
+ * @param whole_files Whether whole files are moved instead of single blocks.
+ * @return The checksum after compaction.
+ */
+static size_t reference_checksum(const std::vector<char> &diskmap, bool whole_files)
+{
+    const long free_block = -1;
+    std::vector<long> blocks;
+    for (size_t i = 0; i < diskmap.size(); ++i)
+    {
+        blocks.insert(blocks.end(), diskmap[i] - '0', i % 2 == 0 ? (long)(i / 2) : free_block);
+    }
+
+    if (!whole_files)
+    {
+        size_t left = 0, right = blocks.size();
+        while (true)
+        {
+            while (left < blocks.size() && blocks[left] != free_block)
+                ++left;
+            while (right > 0 && blocks[right - 1] == free_block)
+                --right;
+            if (right == 0 || left >= right - 1)
+                break;
+            std::swap(blocks[left], blocks[right - 1]);
+        }
+    }
+    else
+    {
+        for (long file_id = (long)(diskmap.size() - 1) / 2; file_id >= 0; --file_id)
+        {
+            size_t start = std::find(blocks.begin(), blocks.end(), file_id) - blocks.begin();
+            size_t size = std::count(blocks.begin(), blocks.end(), file_id);
+            for (size_t gap = 0; gap + size <= start; ++gap)
+            {
+                if (std::all_of(blocks.begin() + gap, blocks.begin() + gap + size, [&](long b) { return b == free_block; }))
+                {
+                    std::fill(blocks.begin() + gap, blocks.begin() + gap + size, file_id);
+                    std::fill(blocks.begin() + start, blocks.begin() + start + size, free_block);
+                    break;
+                }
+            }
+        }
+    }
+
+    size_t checksum = 0;
+    for (size_t pos = 0; pos < blocks.size(); ++pos)
+    {
+        if (blocks[pos] != free_block)
+            checksum += pos * (size_t)blocks[pos];
+    }
+    return checksum;
+}
+
+/**
+ * @brief Generates a random disk map of the given length, with files of 1-9 blocks and free space of 0-9 blocks.
+ * @param length The number of digits in the disk map.
+ * @param seed The random seed.
+ * @return The disk map as a vector of characters.
+ */
+static std::vector<char> random_diskmap(size_t length, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> file_size(1, 9), free_space_size(0, 9);
+    std::vector<char> diskmap;
+    for (size_t i = 0; i < length; ++i)
+    {
+        diskmap.push_back('0' + (i % 2 == 0 ? file_size(generator) : free_space_size(generator)));
+    }
+    return diskmap;
+}
+
 /**
  * @test OneTimeParsedDiskMap
  * @brief Tests parsing of the original disk map into the one-time parsed disk map.
@@ -43,6 +120,18 @@ TEST(DiskFragmenterTest, ChecksumFragmentationAllowed)
     EXPECT_EQ(disk_fragmenter.get_checksum(), 1928);
 }
 
+/**
+ * @test TwoPointerChecksumFragmentationAllowed
+ * @brief Tests the linear two pointer checksum calculation when fragmentation is allowed.
+ */
+TEST(DiskFragmenterTest, TwoPointerChecksumFragmentationAllowed)
+{
+    std::vector<char> original_diskmap = {'2','3','3','3','1','3','3','1','2','1','4','1','4','1','3','1','4','0','2'};
+    EXPECT_EQ(FileFormatter(original_diskmap, true).get_two_pointer_checksum(), 1928);
+    EXPECT_EQ(FileFormatter(std::vector<char>{'1','2','3','4','5'}, true).get_two_pointer_checksum(), 60);
+    EXPECT_EQ(FileFormatter(std::vector<char>{'0','2','3'}, true).get_two_pointer_checksum(), 3);
+}
+
 /**
  * @test RearrangedDiskMap
  * @brief Tests rearrangement of the disk map when fragmentation is not allowed.
@@ -64,4 +153,92 @@ TEST(DiskFragmenterTest, Checksum)
     std::vector<char> original_diskmap = {'2','3','3','3','1','3','3','1','2','1','4','1','4','1','3','1','4','0','2'};
     FileFormatter disk_fragmenter(original_diskmap, false);
     EXPECT_EQ(disk_fragmenter.get_checksum(), 2858);
-}
\ No newline at end of file
+}
+/**
+ * @test FreeSpaceIndexFindsLeftmostFreeSpace
+ * @brief Tests that the free space index returns the leftmost large enough free space before a position.
+ */
+TEST(DiskFragmenterTest, FreeSpaceIndexFindsLeftmostFreeSpace)
+{
+    std::vector<FreeSpace> free_space = {FreeSpace(2, 1), FreeSpace(5, 4), FreeSpace(3, 12)};
+    FreeSpaceIndex free_space_index(free_space);
+    EXPECT_EQ(free_space_index.take_leftmost_free_space(3, 20), 1);
+    EXPECT_EQ(free_space_index.take_leftmost_free_space(3, 20), 2);
+    EXPECT_EQ(free_space_index.take_leftmost_free_space(3, 20), std::nullopt);
+    EXPECT_EQ(free_space_index.take_leftmost_free_space(1, 1), std::nullopt);
+    EXPECT_EQ(free_space_index.take_leftmost_free_space(1, 2), 0);
+}
+
+/**
+ * @test FileExtentChecksum
+ * @brief Tests that the closed form extent checksum equals the sum over its blocks.
+ */
+TEST(DiskFragmenterTest, FileExtentChecksum)
+{
+    EXPECT_EQ(FileExtent(7, 3, 4).get_checksum(), 7 * (3 + 4 + 5 + 6));
+    EXPECT_EQ(FileExtent(7, 3, 0).get_checksum(), 0);
+    EXPECT_EQ(FileExtent(0, 3, 4).get_checksum(), 0);
+}
+
+/**
+ * @test ChecksumForWholeFilesMatchesReference
+ * @brief Tests whole file compaction against a block-by-block reference on random disk maps.
+ */
+TEST(DiskFragmenterTest, ChecksumForWholeFilesMatchesReference)
+{
+    for (unsigned seed = 0; seed < 20; ++seed)
+    {
+        auto diskmap = random_diskmap(101, seed);
+        EXPECT_EQ(FileFormatter(diskmap, false).get_checksum(), reference_checksum(diskmap, true)) << "seed " << seed;
+    }
+}
+
+/**
+ * @test ManagerClassReadsLargeDiskMap
+ * @brief Tests that the chunked reader skips line breaks and spaces in a disk map larger than one read chunk.
+ */
+TEST(DiskFragmenterTest, ManagerClassReadsLargeDiskMap)
+{
+    auto diskmap = random_diskmap(70001, 7);
+    const std::string filename = "large_diskmap_input";
+    {
+        std::ofstream outfile(filename);
+        for (size_t i = 0; i < diskmap.size(); ++i)
+        {
+            outfile << diskmap[i];
+            if (i % 1000 == 999)
+                outfile << " \r\n";
+        }
+        outfile << "\n";
+    }
+    ManagerClass manager(filename);
+    std::remove(filename.c_str());
+    EXPECT_EQ(manager.get_checksum_for_whole_files(), FileFormatter(diskmap, false).get_checksum());
+}
+
+/**
+ * @test ManagerClassAnswersRepeatedQueries
+ * @brief Tests that a single ManagerClass answers both parts, with every engine, and repeated queries.
+ */
+TEST(DiskFragmenterTest, ManagerClassAnswersRepeatedQueries)
+{
+    ManagerClass manager("../small_puzzle_input");
+    EXPECT_EQ(manager.get_checksum(), 1928);
+    EXPECT_EQ(manager.get_checksum_for_whole_files(), 2858);
+    EXPECT_EQ(manager.get_checksum(CompactionEngine::FREE_SPACE_SWAP), 1928);
+    EXPECT_EQ(manager.get_checksum(), 1928);
+    EXPECT_EQ(manager.get_checksum_for_whole_files(), 2858);
+}
+
+/**
+ * @test TwoPointerChecksumMatchesReference
+ * @brief Tests the two pointer compaction against a block-by-block reference on random disk maps.
+ */
+TEST(DiskFragmenterTest, TwoPointerChecksumMatchesReference)
+{
+    for (unsigned seed = 0; seed < 20; ++seed)
+    {
+        auto diskmap = random_diskmap(101 + seed % 2, seed);
+        EXPECT_EQ(FileFormatter(diskmap, true).get_two_pointer_checksum(), reference_checksum(diskmap, false)) << "seed " << seed;
+    }
+}